@@ -0,0 +1,936 @@
+#include "../src/AVLTree.h"
+#include "../src/LearnedIndex.h"
+#include "../src/BlockAVLTree.h"
+#include "../src/AdaptiveAVLTree.h"
+#include "../src/ConcurrentAVLTree.h"
+#include "../src/PersistentAVLTree.h"
+#include "../src/OptimisticAVLTree.h"
+#include "../src/FlatCombiningAVLTree.h"
+#include "../src/ShardedAVLTree.h"
+#include "../src/PartitionedRuntime.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <queue>
+#include <set>
+#include <random>
+#include <sstream>
+using std::cout;
+using std::endl;
+using std::setw;
+using std::map;
+
+/// sink for results that the benchmarks compute only to keep the work from being optimized away
+volatile size_t result_sink = 0;
+
+/**
+ * @brief   Get the seconds elapsed since a point in time
+ * @param   start  point in time
+ * @return  elapsed seconds
+ */
+double secondsSince(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief   Generate ID and name pairs with IDs in an arithmetic sequence
+ * @param   count  number of pairs
+ * @param   first  first ID
+ * @param   stride  difference between consecutive IDs
+ * @return  list of pairs sorted by ID
+ */
+vector<pair<int, string>> makeEntries(const size_t count, const int first, const int stride)
+{
+    vector<pair<int, string>> entries;
+    entries.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const int id = first + static_cast<int>(i) * stride;
+        entries.emplace_back(id, to_string(id));
+    }
+    return entries;
+}
+
+/**
+ * @brief   Get thread counts doubling from 1 up to, and including, the hardware concurrency
+ * @return  list of thread counts
+ */
+vector<unsigned> threadCounts()
+{
+    const unsigned max_threads = max(1u, thread::hardware_concurrency());
+    vector<unsigned> counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) counts.push_back(threads);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+/**
+ * @brief   Time union, intersection and difference of two overlapping trees from 1 to all hardware threads
+ * @param   max_keys  number of keys in each tree
+ */
+void benchSetOperations(const size_t max_keys)
+{
+    const vector<pair<int, string>> evens = makeEntries(max_keys, 0, 2);
+    const vector<pair<int, string>> threes = makeEntries(max_keys, 0, 3);
+
+    cout << "set operations, " << max_keys << " keys per tree (seconds)" << endl;
+    cout << setw(8) << "threads" << setw(12) << "union" << setw(12) << "intersect" << setw(12) << "difference" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        ThreadPool pool(threads);
+        double seconds[3];
+        for (int operation = 0; operation < 3; operation++)
+        {
+            AVLTree tree = AVLTree::buildFromSorted(evens.begin(), evens.end());
+            AVLTree other = AVLTree::buildFromSorted(threes.begin(), threes.end());
+            auto start = std::chrono::steady_clock::now();
+            if (operation == 0) tree.unionWith(std::move(other), AVLTree::KEEP_THIS, &pool);
+            if (operation == 1) tree.intersect(std::move(other), AVLTree::KEEP_THIS, &pool);
+            if (operation == 2) tree.difference(std::move(other), &pool);
+            seconds[operation] = secondsSince(start);
+        }
+        cout << setw(8) << threads << setw(12) << seconds[0] << setw(12) << seconds[1] << setw(12) << seconds[2] << endl;
+    }
+}
+
+/**
+ * @brief   Time searches by name, sequentially and with subtrees forked onto a pool, from 1 to all hardware threads
+ * @param   max_keys  number of keys in the tree
+ */
+void benchNameSearch(const size_t max_keys)
+{
+    vector<pair<int, string>> entries = makeEntries(max_keys, 0, 1);
+    for (size_t i = 0; i < entries.size(); i++) entries[i].second = (i % 1000) ? "common" : "rare";
+    AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+
+    auto start = std::chrono::steady_clock::now();
+    result_sink = tree.search("rare").size();
+    const double sequential_seconds = secondsSince(start);
+
+    cout << "search by name over " << max_keys << " keys (seconds)" << endl;
+    cout << setw(8) << "threads" << setw(12) << "search" << setw(12) << "parallel" << setw(10) << "speedup" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        ThreadPool pool(threads);
+        start = std::chrono::steady_clock::now();
+        result_sink = tree.search("rare", pool).size();
+        const double seconds = secondsSince(start);
+        cout << setw(8) << threads << setw(12) << sequential_seconds << setw(12) << seconds
+             << setw(10) << sequential_seconds / seconds << endl;
+    }
+}
+
+/**
+ * @brief   Time the four traversals sequentially and with subtrees rendered on a pool, from 1 to all hardware threads
+ * @param   max_keys  number of keys in the tree
+ */
+void benchParallelPrint(const size_t max_keys)
+{
+    const vector<pair<int, string>> entries = makeEntries(max_keys, 0, 1);
+    AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+    const AVLTree::Traversal types[] = {AVLTree::INORDER, AVLTree::PREORDER, AVLTree::POSTORDER, AVLTree::LEVELORDER};
+
+    double sequential_seconds[4];
+    for (int i = 0; i < 4; i++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        result_sink = tree.traversalToString(types[i]).size();
+        sequential_seconds[i] = secondsSince(start);
+    }
+
+    cout << "traversals of " << max_keys << " keys, sequential / parallel (seconds)" << endl;
+    cout << setw(8) << "threads" << setw(22) << "inorder" << setw(22) << "preorder" << setw(22) << "postorder"
+         << setw(22) << "levelorder" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        ThreadPool pool(threads);
+        cout << setw(8) << threads;
+        for (int i = 0; i < 4; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            result_sink = tree.traversalToString(types[i], pool).size();
+            const double seconds = secondsSince(start);
+            cout << setw(11) << sequential_seconds[i] << setw(11) << seconds;
+        }
+        cout << endl;
+    }
+}
+
+/**
+ * @brief   Time deep copies of a tree, sequentially and with subtrees forked onto a pool, from 1 to all hardware
+ *          threads, and the time for which clearing the copies blocks the caller
+ * @param   max_keys  number of keys in the tree
+ */
+void benchClone(const size_t max_keys)
+{
+    const vector<pair<int, string>> entries = makeEntries(max_keys, 0, 1);
+    AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+
+    auto start = std::chrono::steady_clock::now();
+    AVLTree copy = tree.clone();
+    const double sequential_seconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    copy.clear();
+    const double clear_seconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    NodeReleaser::wait();
+    const double release_seconds = secondsSince(start);
+
+    cout << "clone of " << max_keys << " keys (seconds)" << endl;
+    cout << "clear returns after " << clear_seconds << ", background release takes " << release_seconds << endl;
+    cout << setw(8) << "threads" << setw(12) << "clone" << setw(12) << "parallel" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        ThreadPool pool(threads);
+        start = std::chrono::steady_clock::now();
+        copy = tree.clone(&pool);
+        const double seconds = secondsSince(start);
+        result_sink = static_cast<size_t>(copy.levelCount());
+        cout << setw(8) << threads << setw(12) << sequential_seconds << setw(12) << seconds << endl;
+        copy.clear();
+        NodeReleaser::wait();
+    }
+}
+
+/**
+ * @brief   Generate random IDs in a range
+ * @param   count  number of IDs
+ * @param   limit  upper bound (exclusive) of the IDs
+ * @return  list of IDs
+ */
+vector<int> makeQueries(const size_t count, const int limit)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, limit - 1);
+    vector<int> queries(count);
+    for (int& query : queries) query = distribution(generator);
+    return queries;
+}
+
+/**
+ * @brief   Get the sizes, by powers of ten from one million, up to a maximum
+ * @param   max_keys  largest size
+ * @return  list of sizes
+ */
+vector<size_t> decadeSizes(const size_t max_keys)
+{
+    vector<size_t> sizes;
+    for (size_t size = 1000000; size < max_keys; size *= 10) sizes.push_back(size);
+    sizes.push_back(max_keys);
+    return sizes;
+}
+
+/**
+ * @brief   Time random lookups, half of them misses, in the pointer tree and in its frozen Eytzinger snapshot
+ * @param   max_keys  largest number of keys
+ */
+void benchFreeze(const size_t max_keys)
+{
+    cout << "point lookups, pointer tree vs. frozen snapshot (nanoseconds per lookup)" << endl;
+    cout << setw(12) << "keys" << setw(10) << "search" << setw(10) << "batch"
+         << setw(10) << "frozen" << setw(14) << "frozen batch" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        const vector<pair<int, string>> entries = makeEntries(keys, 0, 2);
+        AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+        const FrozenAVLTree frozen = tree.freeze();
+        const vector<int> queries = makeQueries(1000000, static_cast<int>(2 * keys));
+
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        const double search = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        found += tree.searchBatch(queries).size();
+        const double batch = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !frozen.search(query).empty();
+        const double frozen_search = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        found += frozen.searchBatch(queries).size();
+        const double frozen_batch = secondsSince(start);
+
+        const double scale = 1e9 / static_cast<double>(queries.size());
+        cout << setw(12) << keys << setw(10) << search * scale << setw(10) << batch * scale
+             << setw(10) << frozen_search * scale << setw(14) << frozen_batch * scale << endl;
+        result_sink = found;
+    }
+}
+
+/**
+ * @brief   Time random lookups in a churned tree before and after compacting it, with its layout statistics
+ * @param   max_keys  number of keys
+ */
+void benchCompact(const size_t max_keys)
+{
+    vector<int> ids = makeQueries(2 * max_keys, static_cast<int>(8 * max_keys));
+    AVLTree tree;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        tree.insert(ids[i], to_string(ids[i]));
+        if (i % 2) tree.remove(ids[i / 2]); // interleaved removals scatter the survivors across the heap
+    }
+    const vector<int> queries = makeQueries(1000000, static_cast<int>(8 * max_keys));
+
+    cout << "compact, churned tree of up to " << max_keys << " keys" << endl;
+    cout << setw(8) << "layout" << setw(16) << "mean link (B)" << setw(16) << "page crossings"
+         << setw(12) << "pages" << setw(12) << "ns/search" << endl;
+    for (const char* layout : {"heap", "vEB"})
+    {
+        if (string(layout) == "vEB") tree.compact();
+        const AVLTree::LayoutStats stats = tree.layoutStats();
+
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        const double seconds = secondsSince(start);
+        result_sink = found;
+
+        cout << setw(8) << layout << setw(16) << stats.mean_edge_bytes << setw(16) << stats.page_crossing_ratio
+             << setw(12) << stats.page_span << setw(12) << seconds * 1e9 / static_cast<double>(queries.size()) << endl;
+    }
+}
+
+/**
+ * @brief   Time random lookups of block-uniform IDs by AVL descent, binary search and learned index
+ * @param   max_keys  largest number of keys
+ */
+void benchLearnedIndex(const size_t max_keys)
+{
+    cout << "point lookups over a frozen sorted ID array (nanoseconds per lookup)" << endl;
+    cout << setw(12) << "keys" << setw(10) << "AVL" << setw(10) << "binary" << setw(10) << "learned"
+         << setw(12) << "segments" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        vector<pair<int, string>> entries;
+        std::mt19937 generator(7);
+        int id = 0;
+        for (size_t i = 0; i < keys; i++)
+        {
+            id += (i % 100000 == 0) ? static_cast<int>(generator() % 1000000) : 1 + static_cast<int>(generator() % 3);
+            entries.emplace_back(id, "x");
+        }
+        AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+        const vector<int> ids = tree.freeze().sortedIds();
+        const LearnedIndex index(ids);
+        const vector<int> queries = makeQueries(1000000, id + 1);
+
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        const double avl = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += std::binary_search(ids.begin(), ids.end(), query);
+        const double binary = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += index.contains(query);
+        const double learned = secondsSince(start);
+        result_sink = found;
+
+        const double scale = 1e9 / static_cast<double>(queries.size());
+        cout << setw(12) << keys << setw(10) << avl * scale << setw(10) << binary * scale
+             << setw(10) << learned * scale << setw(12) << index.segmentCount() << endl;
+    }
+}
+
+/**
+ * @brief   Time random lookups, half of them misses, with and without the hash index, and report its memory overhead
+ * @param   max_keys  largest number of keys
+ */
+void benchHashIndex(const size_t max_keys)
+{
+    cout << "point lookups, tree descent vs. hash index" << endl;
+    cout << setw(12) << "keys" << setw(10) << "tree ns" << setw(10) << "hash ns" << setw(10) << "speedup"
+         << setw(14) << "index B/key" << setw(14) << "node B/key" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        const vector<pair<int, string>> entries = makeEntries(keys, 0, 2);
+        AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+        const vector<int> queries = makeQueries(1000000, static_cast<int>(2 * keys));
+
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        const double descent = secondsSince(start);
+
+        tree.enableHashIndex();
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        const double hashed = secondsSince(start);
+        result_sink = found;
+
+        const double scale = 1e9 / static_cast<double>(queries.size());
+        cout << setw(12) << keys << setw(10) << descent * scale << setw(10) << hashed * scale
+             << setw(10) << descent / hashed
+             << setw(14) << static_cast<double>(tree.hashIndexBytes()) / static_cast<double>(keys)
+             << setw(14) << sizeof(Node) << endl;
+    }
+}
+
+/**
+ * @brief   Time random insertions and lookups, half of them misses, in the pointer tree and in the block tree
+ * @param   max_keys  largest number of keys
+ */
+void benchBlockTree(const size_t max_keys)
+{
+    cout << "pointer tree vs. block tree of " << KeyBlock::CAPACITY << "-ID blocks (nanoseconds per operation)" << endl;
+    cout << setw(12) << "keys" << setw(10) << "insert" << setw(14) << "block insert" << setw(10) << "search"
+         << setw(14) << "block search" << setw(10) << "B/key" << setw(14) << "block B/key" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        const vector<int> ids = makeQueries(keys, static_cast<int>(2 * keys));
+        const vector<int> queries = makeQueries(1000000, static_cast<int>(2 * keys));
+        AVLTree tree;
+        BlockAVLTree blocks;
+
+        size_t inserted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int id : ids) inserted += tree.insert(id, "x");
+        const double insert = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int id : ids) blocks.insert(id, "x");
+        const double block_insert = secondsSince(start);
+
+        size_t found = 0;
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        const double search = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !blocks.search(query).empty();
+        const double block_search = secondsSince(start);
+        result_sink = found;
+
+        const double insert_scale = 1e9 / static_cast<double>(ids.size());
+        const double search_scale = 1e9 / static_cast<double>(queries.size());
+        cout << setw(12) << keys << setw(10) << insert * insert_scale << setw(14) << block_insert * insert_scale
+             << setw(10) << search * search_scale << setw(14) << block_search * search_scale
+             << setw(10) << sizeof(Node)
+             << setw(14) << static_cast<double>(blocks.memoryBytes()) / static_cast<double>(inserted) << endl;
+    }
+}
+
+/**
+ * @brief   Time insertions, lookups and inorder traversals over many small trees, pointer-based vs. adaptive
+ * @param   max_keys  number of keys across the trees of each size
+ */
+void benchAdaptive(const size_t max_keys)
+{
+    cout << "many small trees, pointer tree vs. adaptive (threshold " << AdaptiveAVLTree::DEFAULT_THRESHOLD
+         << "; ns per key, traversals per tree)" << endl;
+    cout << setw(6) << "size" << setw(10) << "insert" << setw(10) << "adaptive" << setw(10) << "search"
+         << setw(10) << "adaptive" << setw(10) << "traverse" << setw(10) << "adaptive" << endl;
+    for (size_t size = 1; size <= 256; size *= 2)
+    {
+        const size_t tree_count = max<size_t>(1, max_keys / size);
+        const vector<int> ids = makeQueries(tree_count * size, static_cast<int>(4 * size));
+        const vector<int> queries = makeQueries(tree_count * size, static_cast<int>(4 * size));
+        vector<AVLTree> trees(tree_count);
+        vector<AdaptiveAVLTree> adaptives(tree_count);
+        double seconds[6] = {};
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ids.size(); i++) trees[i / size].insert(ids[i], "x");
+        seconds[0] = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ids.size(); i++) adaptives[i / size].insert(ids[i], "x");
+        seconds[1] = secondsSince(start);
+
+        size_t found = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); i++) found += !trees[i / size].search(queries[i]).empty();
+        seconds[2] = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); i++) found += !adaptives[i / size].search(queries[i]).empty();
+        seconds[3] = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (AVLTree& tree : trees) found += tree.traversalToString(AVLTree::INORDER).size();
+        seconds[4] = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (AdaptiveAVLTree& tree : adaptives) found += tree.traversalToString(AVLTree::INORDER).size();
+        seconds[5] = secondsSince(start);
+        result_sink = found;
+
+        for (size_t i = 0; i < ids.size(); i++) trees[i / size].remove(ids[i]); // AVLTree frees Nodes only on removal
+        for (size_t i = 0; i < ids.size(); i++) adaptives[i / size].remove(ids[i]);
+
+        const double key_scale = 1e9 / static_cast<double>(ids.size());
+        const double tree_scale = 1e9 / static_cast<double>(tree_count);
+        cout << setw(6) << size << setw(10) << seconds[0] * key_scale << setw(10) << seconds[1] * key_scale
+             << setw(10) << seconds[2] * key_scale << setw(10) << seconds[3] * key_scale
+             << setw(10) << seconds[4] * tree_scale << setw(10) << seconds[5] * tree_scale << endl;
+    }
+}
+
+/**
+ * @brief   Time ascending insertions and an ascending scan of lookups, descending from the root vs. from the finger
+ * @param   max_keys  largest number of keys
+ */
+void benchFinger(const size_t max_keys)
+{
+    cout << "ascending insertions and lookups, root descent vs. finger (nanoseconds per operation)" << endl;
+    cout << setw(12) << "keys" << setw(10) << "insert" << setw(12) << "insertHint" << setw(10) << "search"
+         << setw(12) << "searchNear" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        AVLTree tree, hinted;
+        double seconds[4] = {};
+
+        auto start = std::chrono::steady_clock::now();
+        for (int id = 0; id < static_cast<int>(keys); id++) tree.insert(2 * id, "x");
+        seconds[0] = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int id = 0; id < static_cast<int>(keys); id++) hinted.insertHint(2 * id - 2, 2 * id, "x");
+        seconds[1] = secondsSince(start);
+
+        size_t found = 0;
+        start = std::chrono::steady_clock::now();
+        for (int id = 0; id < static_cast<int>(2 * keys); id++) found += !tree.search(id).empty();
+        seconds[2] = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int id = 0; id < static_cast<int>(2 * keys); id++) found += !hinted.searchNear(id).empty();
+        seconds[3] = secondsSince(start);
+        result_sink = found;
+
+        const double scale = 1e9 / static_cast<double>(keys);
+        cout << setw(12) << keys << setw(10) << seconds[0] * scale << setw(12) << seconds[1] * scale
+             << setw(10) << seconds[2] * scale / 2 << setw(12) << seconds[3] * scale / 2 << endl;
+    }
+}
+
+/**
+ * @brief   Time an ordered work queue, pushing random IDs and popping the least, in the tree and in standard containers
+ * @param   max_keys  largest number of keys
+ */
+void benchOrderedQueue(const size_t max_keys)
+{
+    cout << "ordered queue: push all, then pop-and-push, then drain (nanoseconds per operation)" << endl;
+    cout << setw(12) << "keys" << setw(10) << "popMin" << setw(16) << "removeInorder" << setw(16) << "priority_queue"
+         << setw(10) << "set" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        const vector<int> ids = makeQueries(2 * keys, 1 << 30); // the rare repeats are rejected by the tree and set
+        double seconds[4] = {};
+        size_t popped = 0;
+
+        for (int variant = 0; variant < 2; variant++)
+        {
+            AVLTree tree;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < keys; i++) tree.insert(ids[i], "x");
+            for (size_t i = keys; i < 2 * keys; i++)
+            {
+                popped += variant ? tree.removeInorder(0) : tree.popMin();
+                tree.insert(ids[i], "x");
+            }
+            while (variant ? tree.removeInorder(0) : tree.popMin()) popped++;
+            seconds[variant] = secondsSince(start);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::priority_queue<pair<int, string>, vector<pair<int, string>>, std::greater<pair<int, string>>> heap;
+        for (size_t i = 0; i < keys; i++) heap.emplace(ids[i], "x");
+        for (size_t i = keys; i < 2 * keys; i++)
+        {
+            heap.pop();
+            heap.emplace(ids[i], "x");
+        }
+        while (!heap.empty()) { heap.pop(); popped++; }
+        seconds[2] = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        std::set<pair<int, string>> ordered;
+        for (size_t i = 0; i < keys; i++) ordered.emplace(ids[i], "x");
+        for (size_t i = keys; i < 2 * keys; i++)
+        {
+            ordered.erase(ordered.begin());
+            ordered.emplace(ids[i], "x");
+        }
+        while (!ordered.empty()) { ordered.erase(ordered.begin()); popped++; }
+        seconds[3] = secondsSince(start);
+        result_sink = popped;
+
+        const double scale = 1e9 / static_cast<double>(4 * keys); // 2n pushes and 2n pops
+        cout << setw(12) << keys << setw(10) << seconds[0] * scale << setw(16) << seconds[1] * scale
+             << setw(16) << seconds[2] * scale << setw(10) << seconds[3] * scale << endl;
+    }
+}
+
+/**
+ * @brief   Time removal of a contiguous tenth of the IDs and of a random tenth, one by one vs. in bulk
+ * @param   max_keys  largest number of keys
+ */
+void benchBulkRemove(const size_t max_keys)
+{
+    cout << "removing a tenth of the keys (milliseconds)" << endl;
+    cout << setw(12) << "keys" << setw(14) << "range remove" << setw(13) << "removeRange"
+         << setw(15) << "random remove" << setw(13) << "removeBatch" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        const vector<pair<int, string>> entries = makeEntries(keys, 0, 1);
+        const int low = static_cast<int>(keys / 2);
+        const int high = low + static_cast<int>(keys / 10) - 1;
+        vector<int> ids = makeQueries(keys / 10, static_cast<int>(keys));
+        std::sort(ids.begin(), ids.end());
+        double seconds[4] = {};
+        size_t removed = 0;
+
+        for (int variant = 0; variant < 4; variant++)
+        {
+            AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+            const auto start = std::chrono::steady_clock::now();
+            if (variant == 0) for (int id = low; id <= high; id++) removed += tree.remove(id);
+            if (variant == 1) removed += tree.removeRange(low, high);
+            if (variant == 2) for (int id : ids) removed += tree.remove(id);
+            if (variant == 3) removed += tree.removeBatch(ids);
+            seconds[variant] = secondsSince(start);
+        }
+        result_sink = removed;
+
+        cout << setw(12) << keys << setw(14) << seconds[0] * 1e3 << setw(13) << seconds[1] * 1e3
+             << setw(15) << seconds[2] * 1e3 << setw(13) << seconds[3] * 1e3 << endl;
+    }
+}
+
+/**
+ * @brief   Time mixed lookups and updates of a shared tree from 1 to all hardware threads, by mode and read ratio
+ * @param   max_keys  number of keys
+ */
+void benchConcurrent(const size_t max_keys)
+{
+    const size_t operations = 200000; // per thread
+    cout << "shared tree of " << max_keys << " keys, " << operations << " operations per thread (millions per second)"
+         << endl;
+    cout << setw(8) << "threads" << setw(14) << "lock 99/1" << setw(14) << "seqlock 99/1"
+         << setw(14) << "lock 90/10" << setw(14) << "seqlock 90/10" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        cout << setw(8) << threads;
+        for (unsigned write_percent : {1u, 10u})
+        {
+            for (ConcurrentAVLTree::Mode mode : {ConcurrentAVLTree::SHARED_LOCK, ConcurrentAVLTree::SEQLOCK})
+            {
+                ConcurrentAVLTree tree(mode);
+                for (int id : makeQueries(max_keys, static_cast<int>(2 * max_keys))) tree.insert(id, "x");
+
+                vector<thread> workers;
+                const auto start = std::chrono::steady_clock::now();
+                for (unsigned worker = 0; worker < threads; worker++)
+                {
+                    workers.emplace_back([&tree, worker, write_percent, operations, max_keys]()
+                    {
+                        std::mt19937 generator(worker);
+                        size_t found = 0;
+                        for (size_t i = 0; i < operations; i++)
+                        {
+                            const int id = static_cast<int>(generator() % (2 * max_keys));
+                            if (generator() % 100 >= write_percent) found += !tree.search(id).empty(); else
+                            if (i % 2) tree.remove(id); else tree.insert(id, "x");
+                        }
+                        result_sink = found;
+                    });
+                }
+                for (thread& worker : workers) worker.join();
+                const double seconds = secondsSince(start);
+                cout << setw(14) << static_cast<double>(threads * operations) / seconds / 1e6;
+            }
+        }
+        cout << endl;
+    }
+}
+
+/**
+ * @brief   Time random insertions and lookups in the mutable and the path-copying tree, and lookups by a reader
+ *          while a writer publishes versions
+ * @param   max_keys  largest number of keys
+ */
+void benchPersistent(const size_t max_keys)
+{
+    cout << "mutable vs. persistent tree (nanoseconds per operation)" << endl;
+    cout << setw(12) << "keys" << setw(10) << "insert" << setw(12) << "persistent" << setw(10) << "search"
+         << setw(12) << "persistent" << setw(16) << "under writer" << endl;
+    for (size_t keys : decadeSizes(max_keys))
+    {
+        const vector<int> ids = makeQueries(keys, static_cast<int>(2 * keys));
+        const vector<int> queries = makeQueries(1000000, static_cast<int>(2 * keys));
+        AVLTree tree;
+        PersistentAVLTree persistent;
+        double seconds[5] = {};
+
+        auto start = std::chrono::steady_clock::now();
+        for (int id : ids) tree.insert(id, "x");
+        seconds[0] = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (int id : ids) persistent.insert(id, "x");
+        seconds[1] = secondsSince(start);
+
+        size_t found = 0;
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !tree.search(query).empty();
+        seconds[2] = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !persistent.search(query).empty();
+        seconds[3] = secondsSince(start);
+
+        atomic<bool> is_done(false);
+        thread writer([&persistent, &is_done, keys]()
+        {
+            for (int id = static_cast<int>(2 * keys); !is_done; id++) { persistent.insert(id, "x"); persistent.remove(id); }
+        });
+        start = std::chrono::steady_clock::now();
+        for (int query : queries) found += !persistent.search(query).empty();
+        seconds[4] = secondsSince(start);
+        is_done = true;
+        writer.join();
+        result_sink = found;
+
+        const double insert_scale = 1e9 / static_cast<double>(ids.size());
+        const double search_scale = 1e9 / static_cast<double>(queries.size());
+        cout << setw(12) << keys << setw(10) << seconds[0] * insert_scale << setw(12) << seconds[1] * insert_scale
+             << setw(10) << seconds[2] * search_scale << setw(12) << seconds[3] * search_scale
+             << setw(16) << seconds[4] * search_scale << endl;
+    }
+}
+
+/**
+ * @brief   Time lookup/update mixes on a tree behind one writer lock and on the optimistic tree, from 1 to all
+ *          hardware threads
+ * @param   max_keys  largest number of keys
+ */
+void benchOptimistic(const size_t max_keys)
+{
+    const size_t operations = 200000; // per thread
+    cout << "shared tree of " << max_keys << " keys, " << operations << " operations per thread (millions per second)"
+         << endl;
+    cout << setw(8) << "threads" << setw(12) << "lock 90/10" << setw(18) << "optimistic 90/10"
+         << setw(12) << "lock 50/50" << setw(18) << "optimistic 50/50" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        cout << setw(8) << threads;
+        for (unsigned write_percent : {10u, 50u})
+        {
+            ConcurrentAVLTree locked;
+            OptimisticAVLTree optimistic;
+            for (int id : makeQueries(max_keys, static_cast<int>(2 * max_keys)))
+            {
+                locked.insert(id, "x");
+                optimistic.insert(id, "x");
+            }
+
+            for (bool is_optimistic : {false, true})
+            {
+                vector<thread> workers;
+                const auto start = std::chrono::steady_clock::now();
+                for (unsigned worker = 0; worker < threads; worker++)
+                {
+                    workers.emplace_back([&locked, &optimistic, is_optimistic, worker, write_percent, operations,
+                                          max_keys]()
+                    {
+                        std::mt19937 generator(worker);
+                        size_t found = 0;
+                        for (size_t i = 0; i < operations; i++)
+                        {
+                            const int id = static_cast<int>(generator() % (2 * max_keys));
+                            if (generator() % 100 >= write_percent)
+                                found += is_optimistic ? !optimistic.search(id).empty() : !locked.search(id).empty();
+                            else
+                            if (i % 2) is_optimistic ? optimistic.remove(id) : locked.remove(id);
+                            else is_optimistic ? optimistic.insert(id, "x") : locked.insert(id, "x");
+                        }
+                        result_sink = found;
+                    });
+                }
+                for (thread& worker : workers) worker.join();
+                const double seconds = secondsSince(start);
+                cout << setw(is_optimistic ? 18 : 12) << static_cast<double>(threads * operations) / seconds / 1e6;
+            }
+        }
+        cout << endl;
+    }
+}
+
+/**
+ * @brief   Time random insertions and removals from 1 to 64 writer threads through a plain mutex, the
+ *          reader-writer lock of @c ConcurrentAVLTree and flat combining
+ * @param   max_keys  largest number of keys
+ */
+void benchFlatCombining(const size_t max_keys)
+{
+    const size_t operations = 400000; // across all threads
+    cout << "shared tree of " << max_keys << " keys, " << operations << " updates (millions per second)" << endl;
+    cout << setw(8) << "writers" << setw(10) << "mutex" << setw(10) << "rw-lock" << setw(12) << "combining"
+         << setw(8) << "batch" << endl;
+    for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u})
+    {
+        AVLTree plain;
+        mutex plain_lock;
+        ConcurrentAVLTree locked;
+        FlatCombiningAVLTree combining;
+        for (int id : makeQueries(max_keys, static_cast<int>(2 * max_keys)))
+        {
+            plain.insert(id, "x");
+            locked.insert(id, "x");
+            combining.insert(id, "x");
+        }
+
+        cout << setw(8) << threads;
+        for (int variant = 0; variant < 3; variant++)
+        {
+            vector<thread> workers;
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned worker = 0; worker < threads; worker++)
+            {
+                workers.emplace_back([&, worker, variant]()
+                {
+                    std::mt19937 generator(worker);
+                    for (size_t i = 0; i < operations / threads; i++)
+                    {
+                        const int id = static_cast<int>(generator() % (2 * max_keys));
+                        const bool is_removal = i % 2;
+                        if (variant == 0)
+                        {
+                            lock_guard<mutex> lock(plain_lock);
+                            is_removal ? plain.remove(id) : plain.insert(id, "x");
+                        }
+                        else
+                        if (variant == 1) is_removal ? locked.remove(id) : locked.insert(id, "x");
+                        else is_removal ? combining.remove(id) : combining.insert(id, "x");
+                    }
+                });
+            }
+            for (thread& worker : workers) worker.join();
+            cout << setw(variant == 2 ? 12 : 10) << static_cast<double>(operations) / secondsSince(start) / 1e6;
+        }
+        cout << setw(8) << combining.averageBatch() << endl;
+    }
+}
+
+/**
+ * @brief   Time batched ingestion of random IDs into one tree and into as many shards as threads, and an ordered
+ *          scan of the shards, from 1 to all hardware threads
+ * @param   max_keys  largest number of keys
+ */
+void benchSharded(const size_t max_keys)
+{
+    const size_t batch_size = 10000;
+    const vector<int> ids = makeQueries(max_keys, ShardedAVLTree::ID_LIMIT);
+    cout << "ingestion of " << max_keys << " random IDs in batches of " << batch_size << " (seconds)" << endl;
+    cout << setw(8) << "threads" << setw(12) << "one tree" << setw(12) << "sharded" << setw(12) << "inorder"
+         << setw(10) << "splits" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        ThreadPool pool(threads);
+        AVLTree tree;
+        ShardedAVLTree sharded(threads);
+        double seconds[3] = {};
+        for (size_t first = 0; first < ids.size(); first += batch_size)
+        {
+            vector<pair<int, string>> batch;
+            for (size_t i = first; i < std::min(first + batch_size, ids.size()); i++) batch.emplace_back(ids[i], "x");
+            vector<pair<int, string>> copy = batch;
+
+            auto start = std::chrono::steady_clock::now();
+            tree.insertBatch(std::move(batch));
+            seconds[0] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            sharded.insertBatch(std::move(copy), pool);
+            seconds[1] += secondsSince(start);
+        }
+        const auto start = std::chrono::steady_clock::now();
+        result_sink = sharded.traversalToString().size();
+        seconds[2] = secondsSince(start);
+        cout << setw(8) << threads << setw(12) << seconds[0] << setw(12) << seconds[1] << setw(12) << seconds[2]
+             << setw(10) << sharded.rebalanceCount() << endl;
+    }
+}
+
+/**
+ * @brief   Time a script of insertions and searches by ID run through @c handleCommand on one tree and through a
+ *          @c PartitionedRuntime with a partition per thread, from 1 to all hardware threads
+ * @param   max_keys  number of insertions, each followed by a search
+ */
+void benchPartitioned(const size_t max_keys)
+{
+    std::ostringstream script;
+    for (int id : makeQueries(max_keys, PartitionedRuntime::ID_LIMIT))
+    {
+        string id_str = to_string(id);
+        id_str.insert(0, 8 - id_str.size(), '0');
+        script << "insert \"x\" " << id_str << "\nsearch " << id_str << '\n';
+    }
+    const int command_count = static_cast<int>(2 * max_keys);
+    cout << command_count << " insert and search commands (seconds)" << endl;
+
+    std::istringstream input(script.str());
+    std::ostringstream output;
+    std::streambuf* const cin_buffer = cin.rdbuf(input.rdbuf());
+    std::streambuf* const cout_buffer = cout.rdbuf(output.rdbuf());
+    auto start = std::chrono::steady_clock::now();
+    AVLTree tree;
+    for (int i = 0; i < command_count; i++) tree = handleCommand(std::move(tree));
+    const double single_seconds = secondsSince(start);
+    cin.rdbuf(cin_buffer);
+    cout.rdbuf(cout_buffer);
+    result_sink = output.str().size();
+
+    cout << setw(8) << "threads" << setw(16) << "handleCommand" << setw(14) << "partitioned" << endl;
+    for (unsigned threads : threadCounts())
+    {
+        std::istringstream partitioned_input(script.str());
+        std::ostringstream partitioned_output;
+        PartitionedRuntime runtime(threads);
+        start = std::chrono::steady_clock::now();
+        runtime.run(partitioned_input, partitioned_output, command_count);
+        const double seconds = secondsSince(start);
+        result_sink = partitioned_output.str().size();
+        cout << setw(8) << threads << setw(16) << single_seconds << setw(14) << seconds << endl;
+    }
+}
+
+/// benchmark executable; usage: avl_tree_bench [benchmark name] [max keys]
+int main(int argc, char** argv)
+{
+    const map<string, void (*)(size_t)> benchmarks = {
+            {"set-operations", benchSetOperations},
+            {"name-search", benchNameSearch},
+            {"parallel-print", benchParallelPrint},
+            {"freeze", benchFreeze},
+            {"compact", benchCompact},
+            {"clone", benchClone},
+            {"learned-index", benchLearnedIndex},
+            {"hash-index", benchHashIndex},
+            {"block-tree", benchBlockTree},
+            {"adaptive", benchAdaptive},
+            {"finger", benchFinger},
+            {"ordered-queue", benchOrderedQueue},
+            {"persistent", benchPersistent},
+            {"bulk-remove", benchBulkRemove},
+            {"concurrent", benchConcurrent},
+            {"optimistic", benchOptimistic},
+            {"flat-combining", benchFlatCombining},
+            {"sharded", benchSharded},
+            {"partitioned", benchPartitioned},
+    };
+
+    const string selected = (argc > 1) ? argv[1] : "";
+    const size_t max_keys = (argc > 2) ? std::stoul(argv[2]) : 1000000;
+
+    for (const auto& benchmark : benchmarks)
+    {
+        if (!selected.empty() && selected != benchmark.first) continue;
+        benchmark.second(max_keys);
+        cout << endl;
+    }
+    return 0;
+}
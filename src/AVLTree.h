@@ -2,48 +2,181 @@
 #define AVLTREE_H
 
 #include "Node.h"
+#include "ThreadPool.h"
+#include "FrozenAVLTree.h"
+#include "PresenceBitmap.h"
+#include "HashIndex.h"
+#include "NodeReleaser.h"
 #include <string>
 #include <queue>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <memory>
+#include <iterator>
+#include <new>
 using std::string;
 using std::to_string;
 using std::queue;
+using std::pair;
 using std::max;
+using std::min;
+using std::iota;
+using std::lower_bound;
+using std::stable_sort;
+using std::adjacent_find;
+using std::make_shared;
+
+#ifndef AVL_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define AVL_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define AVL_PREFETCH(address) ((void)(address))
+#endif
+#endif
 
 /// Object class for a self-balancing (Adelson-Velsky and Landis) tree
 class AVLTree {
 
 private:
     Node* _root = nullptr;
+    vector<shared_ptr<NodeArena>> _arenas; // blocks holding relocated Nodes, shared with trees split from this one
+    shared_ptr<PresenceBitmap> _presence; // optional index of the IDs present, kept in sync by every mutation
+    shared_ptr<HashIndex> _hash; // optional index from ID to Node, kept in sync by every mutation
+    struct FingerStep { Node* node; Node* lower; Node* upper; }; // a Node and its nearest ancestors bounding its IDs
+    vector<FingerStep> _finger; // path from the root to the last Node reached by insertHint or searchNear
+    vector<Node*> _leftSpine; // path from the root to the leftmost Node, once min or popMin builds it
+    vector<Node*> _rightSpine; // path from the root to the rightmost Node, once max or popMax builds it
+    vector<Node*>* _retired = nullptr; // when set, unlinked Nodes are collected here for a later release
+    size_t _retiredCount = 0; // Nodes collected in a retired list and not yet released
+    vector<shared_ptr<NodeArena>> _retiredArenas; // arenas dropped while Nodes retired from them are outstanding
     static Node* _rotateLeft(Node* root);
     static Node* _rotateRight(Node* root);
     static Node* _rotateRightLeft(Node* root);
     static Node* _rotateLeftRight(Node* root);
+    static Node* _loadLink(Node* const& link);
+    static void _storeLink(Node*& link, Node* node);
+    static Node* _find(Node* root, int id);
     static Node* _getLeftmost(Node* root);
+    static Node* _getRightmost(Node* root);
+    static Node* _detachLeftmost(Node* root, Node*& leftmost);
     static int _getHeight(Node* root);
     static void _updateHeight(Node* root);
     static int _getBalance(Node* root);
     static Node* _updateBalance(Node* root);
-    static Node* _deleteNode(Node* root, Node* parent);
-    static string _idToString(int id);
+    static Node* _joinLeft(Node* left, Node* pivot, Node* right);
+    static Node* _joinRight(Node* left, Node* pivot, Node* right);
+    static Node* _join(Node* left, Node* pivot, Node* right);
+    static Node* _concatenate(Node* left, Node* right);
+    static Node* _split(Node* root, int id, Node*& left, Node*& right);
+    static Node* _link(Node** nodes, size_t count);
+    static void _flatten(Node* root, vector<Node*>& nodes);
+    template <typename Iterator> static Node* _buildSorted(Iterator& next, size_t count);
+    template <typename Iterator> static Node* _buildSortedParallel(Iterator first, size_t count, ThreadPool& pool);
+    static const size_t PARALLEL_BUILD_GRAIN = 1 << 14;
+    static const int PARALLEL_SET_HEIGHT = 12;
+    static const int PARALLEL_SCAN_HEIGHT = 14;
+    static Node* _unlink(Node* root);
+    static Node* _cloneSubtree(const Node* root, const vector<shared_ptr<NodeArena>>& sources,
+                               const vector<shared_ptr<NodeArena>>& arenas, ThreadPool* pool);
+    static const int BACKGROUND_RELEASE_HEIGHT = 14;
+    void _releaseAll();
+    vector<shared_ptr<NodeArena>> _takeArenas();
+    void _freeNode(Node* node);
+    void _releaseNode(Node* node);
+    void _deleteNode(Node* node);
+    bool _isIndexed() const;
+    void _indexInsert(Node* node);
+    void _indexRemove(Node* node);
+    void _indexSubtree(Node* root, bool is_present);
+    void _rebuildIndexes();
+    void _shareArenas(const AVLTree& other);
+    void _dropCursors();
+    void _seekFinger(int id);
+    void _buildSpine(vector<Node*>& spine, bool is_left);
+    Node* _popSpine(vector<Node*>& spine, bool is_left);
+    void _extendFinger(int id);
+    static void _collectLevel(Node* root, int depth, vector<Node*>& nodes);
+    static void _orderVanEmdeBoas(Node* root, int levels, vector<Node*>& order);
     static void _copyInorder(Node* root, string& names);
     static void _copyPreorder(Node* root, string& names);
     static void _copyPostorder(Node* root, string& names);
     static void _copyLevelorder(Node* root, string& names);
-    static Node* _insert(Node* root, int id, const string& name);
-    static bool _remove(Node* root, Node* parent, int id);
-    static bool _removeInorder(Node* root, Node* parent, int* count);
+    static void _splitTraversal(Node* root, int type, vector<Node*>& subtrees, vector<string>& buffers);
+    static void _copyLevelorderParallel(Node* root, vector<string>& buffers, ThreadPool& pool);
+    static string _assemble(vector<string>& buffers, ThreadPool& pool);
+    static const size_t PARALLEL_COPY_GRAIN = 1 << 16;
+    static const size_t PARALLEL_LEVEL_GRAIN = 1 << 14;
+    static Node* _insert(Node* root, Node* node);
+    static Node* _insertBatch(Node* root, Node** batch, size_t count, bool* is_rejected);
+    static Node* _mergeBatch(Node* root, Node** batch, size_t count, bool* is_rejected);
+    static Node* _union(Node* root, Node* other, int policy, vector<Node*>& discards, ThreadPool* pool);
+    static Node* _intersect(Node* root, Node* other, int policy, vector<Node*>& discards, ThreadPool* pool);
+    static Node* _difference(Node* root, Node* other, vector<Node*>& discards, ThreadPool* pool);
+    static Node* _remove(Node* root, int id, Node*& removal);
+    static Node* _removeInorder(Node* root, int* count, Node*& removal);
+    static Node* _removeBatch(Node* root, const int* ids, size_t count, vector<Node*>& removals);
+    static Node* _selectInorder(Node* root, int& count);
+    size_t _deleteSubtree(Node* root);
     static void _search(Node* root, int id, string& match);
     static void _search(Node* root, const string& name, vector<string>& matches);
+    static void _searchParallel(Node* root, const string& name, vector<string>& matches, ThreadPool& pool);
+    static void _searchBatch(Node* root, const int* ids, size_t count, string* matches);
+    static const size_t SEARCH_GROUP_SIZE = 16;
 
 public:
     enum Traversal { INORDER, PREORDER, POSTORDER, LEVELORDER };
+    enum Conflict { KEEP_THIS, KEEP_OTHER };
+    AVLTree() = default;
+    AVLTree(const AVLTree& other);
+    AVLTree(AVLTree&& other) noexcept;
+    AVLTree& operator=(const AVLTree& other);
+    AVLTree& operator=(AVLTree&& other) noexcept;
+    ~AVLTree();
+    AVLTree clone(ThreadPool* pool = nullptr) const;
+    void clear();
+    template <typename Iterator> static AVLTree buildFromSorted(Iterator first, Iterator last);
+    template <typename Iterator> static AVLTree buildFromSortedParallel(Iterator first, Iterator last, ThreadPool& pool);
     bool insert(int id, const string& name);
+    bool insertHint(int hint, int id, const string& name);
+    vector<bool> insertBatch(vector<pair<int, string>>&& entries);
+    static AVLTree join(AVLTree&& left, int id, const string& name, AVLTree&& right);
+    bool split(int id, AVLTree& left, string& name, AVLTree& right);
+    AVLTree splitOff(int id);
+    void unionWith(AVLTree&& other, Conflict policy = KEEP_THIS, ThreadPool* pool = nullptr);
+    void intersect(AVLTree&& other, Conflict policy = KEEP_THIS, ThreadPool* pool = nullptr);
+    void difference(AVLTree&& other, ThreadPool* pool = nullptr);
     bool remove(int id);
     bool removeInorder(int count);
+    size_t removeRange(int low, int high);
+    size_t removeBatch(const vector<int>& ids);
+    size_t removeInorderRange(int first, int last);
+    int min();
+    int max();
+    bool popMin(int* id = nullptr, string* name = nullptr);
+    bool popMax(int* id = nullptr, string* name = nullptr);
     string search(int id);
+    const Node* find(int id) const;
+    string searchNear(int id);
     vector<string> search(const string& name);
+    vector<string> search(const string& name, ThreadPool& pool);
+    vector<string> searchBatch(const vector<int>& ids);
+    static string idToString(int id);
+    void deferFrees(vector<Node*>* retired);
+    void releaseDeferred(vector<Node*>& retired);
+    void enablePresenceBitmap();
+    void enableHashIndex();
+    size_t hashIndexBytes();
+    size_t rank(int id);
+    int selectInorder(int count);
     string traversalToString(Traversal type);
+    string traversalToString(Traversal type, ThreadPool& pool);
     int levelCount();
+    vector<pair<int, string>> sortedEntries();
+    FrozenAVLTree freeze();
+    struct LayoutStats { double mean_edge_bytes; double page_crossing_ratio; size_t page_span; };
+    LayoutStats layoutStats();
+    void compact();
 };
 
 /**
@@ -55,8 +188,10 @@ Node* AVLTree::_rotateRight(Node* root)
 {
     Node* left = root->left;
     Node* leftRight = left->right;
-    left->right = root;
-    root->left = leftRight;
+    _storeLink(left->right, root);
+    _storeLink(root->left, leftRight);
+    _updateHeight(root);
+    _updateHeight(left);
     return left;
 }
 
@@ -69,8 +204,10 @@ Node* AVLTree::_rotateLeft(Node* root)
 {
     Node* right = root->right;
     Node* rightLeft = right->left;
-    right->left = root;
-    root->right = rightLeft;
+    _storeLink(right->left, root);
+    _storeLink(root->right, rightLeft);
+    _updateHeight(root);
+    _updateHeight(right);
     return right;
 }
 
@@ -81,7 +218,7 @@ Node* AVLTree::_rotateLeft(Node* root)
  */
 Node* AVLTree::_rotateRightLeft(Node* root)
 {
-    root->right = _rotateRight(root->right);
+    _storeLink(root->right, _rotateRight(root->right));
     return _rotateLeft(root);
 }
 
@@ -92,51 +229,109 @@ Node* AVLTree::_rotateRightLeft(Node* root)
  */
 Node* AVLTree::_rotateLeftRight(Node* root)
 {
-    root->left = _rotateLeft(root->left);
+    _storeLink(root->left, _rotateLeft(root->left));
     return _rotateRight(root);
 }
 
+/**
+ *  @brief  Read a link of the tree that a writer may be storing meanwhile
+ *  @param  link  child pointer of a @c Node, or the root pointer
+ *  @return pointer to the linked @c Node, whose ID and name are visible once it is reached
+ */
+Node* AVLTree::_loadLink(Node* const& link)
+{
+    return __atomic_load_n(&link, __ATOMIC_ACQUIRE);
+}
+
+/**
+ *  @brief  Write a link of the tree that a reader may be loading meanwhile
+ *  @param  link  child pointer of a @c Node, or the root pointer
+ *  @param  node  pointer to the @c Node to link
+ */
+void AVLTree::_storeLink(Node*& link, Node* const node)
+{
+    __atomic_store_n(&link, node, __ATOMIC_RELEASE);
+}
+
+/**
+ *  @brief  Find, by ID, a @c Node of a tree
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  id  integer ID
+ *  @return pointer to the @c Node; @c nullptr if not found
+ *  @note   the links are loaded atomically, since the descent may run alongside @c insert, @c remove and
+ *          @c removeInorder, which store them atomically; what it finds then must be validated by the caller
+ *  @complexity O(log n) (worst-case)
+ */
+Node* AVLTree::_find(Node* root, const int id)
+{
+    while (root && root->id != id) root = _loadLink((id < root->id) ? root->left : root->right);
+    return root;
+}
+
 /**
  *  @brief  Get the leftmost @c Node of a tree branch
  *  @param  root pointer to the root @c Node of the tree branch
  *  @return pointer to the leftmost @c Node of the tree branch
+ *  @complexity O(log n) (worst-case)
  */
 Node* AVLTree::_getLeftmost(Node* root)
 {
     if (!root) return nullptr;
-    if (!root->left->left)
+    while (root->left) root = root->left;
+    return root;
+}
+
+/**
+ *  @brief  Get the rightmost @c Node of a tree branch
+ *  @param  root pointer to the root @c Node of the tree branch
+ *  @return pointer to the rightmost @c Node of the tree branch
+ *  @complexity O(log n) (worst-case)
+ */
+Node* AVLTree::_getRightmost(Node* root)
+{
+    if (!root) return nullptr;
+    while (root->right) root = root->right;
+    return root;
+}
+
+/**
+ *  @brief  Detach the leftmost @c Node of a tree branch
+ *  @param  root  pointer to the root @c Node of the tree branch
+ *  @param  leftmost  pointer to which the detached leftmost @c Node is copied
+ *  @return pointer to the root @c Node of the rebalanced tree branch
+ *  @complexity O(log n) (worst-case)
+ */
+Node* AVLTree::_detachLeftmost(Node* root, Node*& leftmost)
+{
+    if (!root->left)
     {
-        Node* leftmost = root->left;
-        root->left = leftmost->right;
-        return leftmost;
+        leftmost = root;
+        Node* right = root->right;
+        _storeLink(root->right, nullptr);
+        return right;
     }
-    return _getLeftmost(root->left);
+    _storeLink(root->left, _detachLeftmost(root->left, leftmost));
+    return _updateBalance(root);
 }
 
 /**
  *  @brief  Get the height of a tree
  *  @param  root pointer to the root @c Node of the tree
- *  @return height of the tree
+ *  @return height of the tree; -1 for an empty tree
+ *  @complexity O(1)
  */
 int AVLTree::_getHeight(Node* root)
 {
-    if (!root) return -1;
-    int left_height = _getHeight(root->left);
-    int right_height = _getHeight(root->right);
-    return 1 + max(left_height, right_height);
+    return root ? root->height : -1;
 }
 
 /**
- *  @brief Update the height of a tree
+ *  @brief Update the height of a tree from the heights of its subtrees
  *  @param root pointer to the root @c Node of the tree
  */
 void AVLTree::_updateHeight(Node* root)
 {
-    Node* left = root->left;
-    Node* right = root->right;
-    if (left) left->height = _getHeight(root->left);
-    root->height = _getHeight(root);
-    if (right) right->height = _getHeight(root->right);
+    root->height = 1 + std::max(_getHeight(root->left), _getHeight(root->right));
 }
 
 /**
@@ -150,12 +345,13 @@ int AVLTree::_getBalance(Node* root)
 }
 
 /**
- *  @brief  Update the balance factor of a tree
+ *  @brief  Update the height and the balance factor of a tree whose subtrees are balanced
  *  @param  root  pointer to the root @c Node of the tree
  *  @return pointer to the root @c Node of the updated tree
  */
 Node* AVLTree::_updateBalance(Node* root)
 {
+    _updateHeight(root);
     const int balance = _getBalance(root);
     if (balance < -1)
     {
@@ -171,66 +367,572 @@ Node* AVLTree::_updateBalance(Node* root)
 }
 
 /**
- *  @brief  Delete a @c Node from a tree
+ *  @brief  Join two trees and a pivot @c Node, where the left tree is taller than the right
+ *  @param  left  pointer to the root @c Node of the tree whose IDs precede the pivot
+ *  @param  pivot  pointer to the @c Node to be placed between the trees
+ *  @param  right  pointer to the root @c Node of the tree whose IDs follow the pivot
+ *  @return pointer to the root @c Node of the joined tree
+ *  @complexity O(|h(left) - h(right)|) (worst-case)
+ */
+Node* AVLTree::_joinRight(Node* left, Node* pivot, Node* right)
+{
+    if (_getHeight(left->right) <= _getHeight(right) + 1)
+    {
+        pivot->left = left->right;
+        pivot->right = right;
+        _updateHeight(pivot);
+        left->right = pivot;
+    }
+    else left->right = _joinRight(left->right, pivot, right);
+    return _updateBalance(left);
+}
+
+/**
+ *  @brief  Join two trees and a pivot @c Node, where the right tree is taller than the left
+ *  @param  left  pointer to the root @c Node of the tree whose IDs precede the pivot
+ *  @param  pivot  pointer to the @c Node to be placed between the trees
+ *  @param  right  pointer to the root @c Node of the tree whose IDs follow the pivot
+ *  @return pointer to the root @c Node of the joined tree
+ *  @complexity O(|h(left) - h(right)|) (worst-case)
+ */
+Node* AVLTree::_joinLeft(Node* left, Node* pivot, Node* right)
+{
+    if (_getHeight(right->left) <= _getHeight(left) + 1)
+    {
+        pivot->left = left;
+        pivot->right = right->left;
+        _updateHeight(pivot);
+        right->left = pivot;
+    }
+    else right->left = _joinLeft(left, pivot, right->left);
+    return _updateBalance(right);
+}
+
+/**
+ *  @brief  Join two trees and a pivot @c Node into one tree
+ *  @param  left  pointer to the root @c Node of the tree whose IDs precede the pivot
+ *  @param  pivot  pointer to the @c Node to be placed between the trees
+ *  @param  right  pointer to the root @c Node of the tree whose IDs follow the pivot
+ *  @return pointer to the root @c Node of the joined tree
+ *  @complexity O(|h(left) - h(right)|) (worst-case)
+ */
+Node* AVLTree::_join(Node* left, Node* pivot, Node* right)
+{
+    const int left_height = _getHeight(left);
+    const int right_height = _getHeight(right);
+    if (left_height > right_height + 1) return _joinRight(left, pivot, right);
+    if (right_height > left_height + 1) return _joinLeft(left, pivot, right);
+
+    pivot->left = left;
+    pivot->right = right;
+    _updateHeight(pivot);
+    return pivot;
+}
+
+/**
+ *  @brief  Join two trees into one tree, taking the leftmost @c Node of the right tree as the pivot
+ *  @param  left  pointer to the root @c Node of the tree whose IDs precede those of the right tree
+ *  @param  right  pointer to the root @c Node of the tree whose IDs follow those of the left tree
+ *  @return pointer to the root @c Node of the joined tree
+ *  @complexity O(log n) (worst-case)
+ */
+Node* AVLTree::_concatenate(Node* left, Node* right)
+{
+    if (!left) return right;
+    if (!right) return left;
+
+    Node* pivot = nullptr;
+    right = _detachLeftmost(right, pivot);
+    return _join(left, pivot, right);
+}
+
+/**
+ *  @brief  Split a tree, by ID, into the trees of lesser and of greater IDs
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  id  integer ID
+ *  @param  left  pointer to which the root @c Node of the tree of lesser IDs is copied
+ *  @param  right  pointer to which the root @c Node of the tree of greater IDs is copied
+ *  @return pointer to the detached @c Node with the ID; @c nullptr if the ID is not found
+ *  @complexity O(log n) (worst-case)
+ */
+Node* AVLTree::_split(Node* root, const int id, Node*& left, Node*& right)
+{
+    if (!root)
+    {
+        left = nullptr;
+        right = nullptr;
+        return nullptr;
+    }
+
+    Node* root_left = root->left;
+    Node* root_right = root->right;
+    const int root_id = root->id;
+
+    if (id < root_id)
+    {
+        Node* match = _split(root_left, id, left, right);
+        right = _join(right, root, root_right);
+        return match;
+    }
+
+    if (id > root_id)
+    {
+        Node* match = _split(root_right, id, left, right);
+        left = _join(root_left, root, left);
+        return match;
+    }
+
+    left = root_left;
+    right = root_right;
+    root->left = nullptr;
+    root->right = nullptr;
+    root->height = 0;
+    return root;
+}
+
+/**
+ *  @brief  Link an array of @c Nodes, sorted by ID, into a perfectly balanced tree
+ *  @param  nodes  array of pointers to @c Nodes
+ *  @param  count  number of @c Nodes in the array
+ *  @return pointer to the root @c Node of the tree
+ *  @complexity O(n) (worst-case)
+ */
+Node* AVLTree::_link(Node** nodes, const size_t count)
+{
+    if (!count) return nullptr;
+
+    const size_t middle = count / 2;
+    Node* root = nodes[middle];
+    root->left = _link(nodes, middle);
+    root->right = _link(nodes + middle + 1, count - middle - 1);
+    _updateHeight(root);
+    return root;
+}
+
+/**
+ *  @brief Copy the @c Nodes of a tree, in inorder sequence, to a list
+ *  @param root  pointer to the root @c Node of the tree
+ *  @param nodes  list to which pointers to the @c Nodes are copied
+ *  @complexity O(n) (worst-case)
+ */
+void AVLTree::_flatten(Node* root, vector<Node*>& nodes)
+{
+    if (!root) return;
+
+    _flatten(root->left, nodes);
+    nodes.push_back(root);
+    _flatten(root->right, nodes);
+}
+
+/**
+ *  @brief  Create a perfectly balanced tree from a sequence of ID and name pairs, sorted by and unique in ID
+ *  @param  next  iterator to the first pair; advanced past the last pair consumed
+ *  @param  count  number of pairs to consume
+ *  @return pointer to the root @c Node of the tree
+ *  @complexity O(n) (worst-case)
+ */
+template <typename Iterator>
+Node* AVLTree::_buildSorted(Iterator& next, const size_t count)
+{
+    if (!count) return nullptr;
+
+    const size_t middle = count / 2;
+    Node* left = _buildSorted(next, middle);
+    Node* root = new Node(next->first, next->second);
+    ++next;
+    root->left = left;
+    root->right = _buildSorted(next, count - middle - 1);
+    _updateHeight(root);
+    return root;
+}
+
+/**
+ *  @brief  Create a perfectly balanced tree from a sequence of ID and name pairs, forking the builds of large halves
+ *  @param  first  random-access iterator to the first pair
+ *  @param  count  number of pairs
+ *  @param  pool  pool onto which the left halves of sequences of at least @c PARALLEL_BUILD_GRAIN pairs are forked
+ *  @return pointer to the root @c Node of the tree
+ *  @complexity O(n) work, O(log n + n / p) span for p threads (worst-case)
+ */
+template <typename Iterator>
+Node* AVLTree::_buildSortedParallel(Iterator first, const size_t count, ThreadPool& pool)
+{
+    if (count < PARALLEL_BUILD_GRAIN) return _buildSorted(first, count);
+
+    const size_t middle = count / 2;
+    Node* left = nullptr;
+    shared_ptr<ThreadPool::Task> task = pool.fork([&]()
+    {
+        left = _buildSortedParallel(first, middle, pool);
+    });
+    Node* right = _buildSortedParallel(first + (middle + 1), count - middle - 1, pool);
+    pool.join(task);
+
+    Node* root = new Node(first[middle].first, first[middle].second);
+    root->left = left;
+    root->right = right;
+    _updateHeight(root);
+    return root;
+}
+
+/**
+ *  @brief  Unlink the root @c Node from a tree, leaving the @c Node itself intact
  *  @param  root  pointer to the root @c Node of the tree
- *  @param  parent  pointer to the parent of the root @c Node
- *  @return pointer to the root @c Node of the updated tree
+ *  @return pointer to the root @c Node of the tree that replaces it
+ *  @complexity O(log n) (worst-case)
  */
-Node* AVLTree::_deleteNode(Node* root, Node* parent)
+Node* AVLTree::_unlink(Node* root)
 {
     Node* left = root->left;
     Node* right = root->right;
+    _storeLink(root->left, nullptr);
+    _storeLink(root->right, nullptr);
+
+    if (!left) return right;
+    if (!right) return left;
+
+    Node* successor = nullptr;
+    right = _detachLeftmost(right, successor);
+    _storeLink(successor->left, left);
+    _storeLink(successor->right, right);
+    return _updateBalance(successor);
+}
+
+/**
+ *  @brief  Copy a tree, placing the copy of each @c Node held by an arena in the same slot of the matching arena
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  sources  arenas that may hold the @c Nodes of the tree
+ *  @param  arenas  arenas of the copy, each as large as the source arena at the same index
+ *  @param  pool  pool onto which the right subtrees of large trees are forked; @c nullptr to run sequentially
+ *  @return pointer to the root @c Node of the copy
+ *  @complexity O(n) work, O(log n + n / p) span for p threads (worst-case)
+ */
+Node* AVLTree::_cloneSubtree(const Node* root, const vector<shared_ptr<NodeArena>>& sources,
+                             const vector<shared_ptr<NodeArena>>& arenas, ThreadPool* pool)
+{
+    if (!root) return nullptr;
 
-    if (!left && !right)
+    Node* copy = nullptr;
+    for (size_t i = 0; i < sources.size() && !copy; i++)
     {
-        Node* removal = root;
-        if (parent)
-        {
-            if (parent->left == root) parent->left = nullptr;
-            else if (parent->right == root) parent->right = nullptr;
-        }
-        delete removal;
-        root = parent;
+        if (sources[i]->contains(root)) copy = new (arenas[i]->nodes + (root - sources[i]->nodes)) Node(root->id, root->name);
     }
+    if (!copy) copy = new Node(root->id, root->name);
+    copy->height = root->height;
 
+    if (pool && root->height >= PARALLEL_SET_HEIGHT)
+    {
+        shared_ptr<ThreadPool::Task> task = pool->fork([&]()
+        {
+            copy->right = _cloneSubtree(root->right, sources, arenas, pool);
+        });
+        copy->left = _cloneSubtree(root->left, sources, arenas, pool);
+        pool->join(task);
+    }
     else
-    if (left && !right)
     {
-        root->id = left->id;
-        root->name = left->name;
-        root->left = left->left;
-        root->right = left->right;
-        delete left;
+        copy->left = _cloneSubtree(root->left, sources, arenas, pool);
+        copy->right = _cloneSubtree(root->right, sources, arenas, pool);
     }
+    return copy;
+}
 
-    else
-    if (!left)
+/**
+ *  @brief  Unlink and free every @c Node of @c this tree, leaving the indexes to the caller; large trees are
+ *          freed on the background thread of @c NodeReleaser, and while @c deferFrees is in effect the
+ *          @c Nodes are retired instead
+ *  @complexity O(1) for trees taller than @c BACKGROUND_RELEASE_HEIGHT, O(n) otherwise (worst-case)
+ */
+void AVLTree::_releaseAll()
+{
+    Node* root = _root;
+    _root = nullptr;
+    _dropCursors();
+    if (_retired)
     {
-        root->id = right->id;
-        root->name = right->name;
-        root->left = right->left;
-        root->right = right->right;
-        delete right;
+        const size_t retired_count = _retired->size();
+        _flatten(root, *_retired);
+        _retiredCount += _retired->size() - retired_count;
+        _takeArenas(); // kept until releaseDeferred, which looks the Nodes up in them
+        return;
     }
 
-    else
-    if (!right->left)
+    if (_getHeight(root) >= BACKGROUND_RELEASE_HEIGHT) NodeReleaser::release(root, _arenas);
+    else NodeReleaser::releaseSubtree(root, _arenas);
+    _arenas.clear();
+}
+
+/**
+ *  @brief  Take the arenas of @c this tree away from it, keeping them alive as long as @c Nodes retired from
+ *          them are outstanding
+ *  @return arenas
+ */
+vector<shared_ptr<NodeArena>> AVLTree::_takeArenas()
+{
+    if (_retiredCount) _retiredArenas.insert(_retiredArenas.end(), _arenas.begin(), _arenas.end());
+    vector<shared_ptr<NodeArena>> arenas = std::move(_arenas);
+    _arenas.clear();
+    return arenas;
+}
+
+/**
+ *  @brief  Free the memory of a @c Node that is not linked into @c this tree, leaving its ID indexed;
+ *          deferred to @c releaseDeferred while @c deferFrees is in effect
+ *  @param  node  pointer to the @c Node
+ */
+void AVLTree::_freeNode(Node* node)
+{
+    if (!_retired) return _releaseNode(node);
+    _retired->push_back(node);
+    _retiredCount++;
+}
+
+/**
+ *  @brief  Free the memory of a @c Node at once, whether or not frees are deferred
+ *  @param  node  pointer to the @c Node
+ */
+void AVLTree::_releaseNode(Node* node)
+{
+    for (const shared_ptr<NodeArena>& arena : _retiredArenas)
     {
-        root->id = right->id;
-        root->name = right->name;
-        root->right = right->right;
-        delete right;
+        if (!arena->contains(node)) continue;
+        node->~Node(); // the slot is freed with the arena, once no retired Node is left in it
+        return;
     }
+    NodeReleaser::releaseNode(node, _arenas);
+}
 
-    else
+/**
+ *  @brief  Delete a @c Node that has been unlinked from @c this tree, removing its ID from the indexes
+ *  @param  node  pointer to the @c Node
+ */
+void AVLTree::_deleteNode(Node* node)
+{
+    _indexRemove(node);
+    _freeNode(node);
+}
+
+/**
+ *  @brief  Delete every @c Node of a tree that has been unlinked from @c this tree
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @return number of deleted @c Nodes
+ *  @complexity O(n) (worst-case)
+ */
+size_t AVLTree::_deleteSubtree(Node* root)
+{
+    if (!root) return 0;
+
+    const size_t count = _deleteSubtree(root->left) + _deleteSubtree(root->right) + 1;
+    _deleteNode(root);
+    return count;
+}
+
+/**
+ *  @brief  Check whether any optional index is enabled on @c this tree
+ *  @return boolean indicating whether an index is enabled
+ */
+bool AVLTree::_isIndexed() const
+{
+    return _presence || _hash;
+}
+
+/**
+ *  @brief  Add a @c Node linked into @c this tree to the indexes
+ *  @param  node  pointer to the @c Node
+ */
+void AVLTree::_indexInsert(Node* node)
+{
+    if (_presence && PresenceBitmap::inDomain(node->id)) _presence->set(node->id);
+    if (_hash) _hash->insert(node);
+}
+
+/**
+ *  @brief  Remove a @c Node unlinked from @c this tree from the indexes
+ *  @param  node  pointer to the @c Node
+ */
+void AVLTree::_indexRemove(Node* node)
+{
+    if (_presence && PresenceBitmap::inDomain(node->id)) _presence->reset(node->id);
+    if (_hash) _hash->erase(node->id);
+}
+
+/**
+ *  @brief  Add the @c Nodes of a tree to, or remove them from, the indexes
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  is_present  boolean indicating whether the @c Nodes are being added
+ *  @complexity O(n) (worst-case)
+ */
+void AVLTree::_indexSubtree(Node* root, const bool is_present)
+{
+    if (!root || !_isIndexed()) return;
+
+    if (is_present) _indexInsert(root);
+    else _indexRemove(root);
+    _indexSubtree(root->left, is_present);
+    _indexSubtree(root->right, is_present);
+}
+
+/**
+ *  @brief  Rebuild the indexes from the @c Nodes of @c this tree, after a restructuring too broad to track
+ *  @complexity O(n) (worst-case)
+ */
+void AVLTree::_rebuildIndexes()
+{
+    if (_presence) _presence->clear();
+    if (_hash) _hash->clear();
+    _indexSubtree(_root, true);
+}
+
+/**
+ *  @brief  Share the arenas of another tree, whose @c Nodes are being moved into @c this tree
+ *  @param  other  tree from which @c Nodes are moved
+ */
+void AVLTree::_shareArenas(const AVLTree& other)
+{
+    for (const shared_ptr<NodeArena>& arena : other._arenas)
+        if (std::find(_arenas.begin(), _arenas.end(), arena) == _arenas.end()) _arenas.push_back(arena);
+}
+
+/**
+ *  @brief  Forget the finger and spines of @c this tree, after a mutation they do not follow
+ */
+void AVLTree::_dropCursors()
+{
+    _finger.clear();
+    _leftSpine.clear();
+    _rightSpine.clear();
+}
+
+/**
+ *  @brief  Point the finger of @c this tree at an ID, descending from the root
+ *  @param  id  integer ID
+ *  @complexity O(log n) (worst-case)
+ */
+void AVLTree::_seekFinger(const int id)
+{
+    _finger.clear();
+    if (!_root) return;
+    _finger.push_back({_root, nullptr, nullptr});
+    _extendFinger(id);
+}
+
+/**
+ *  @brief  Extend the finger of @c this tree toward an ID, from its last @c Node down to the @c Node with
+ *          the ID or, if it is absent, to the @c Node under which it would be linked
+ *  @param  id  integer ID, within the bounds of the last step of the finger
+ *  @complexity O(log d) (worst-case), for the height d of the subtree under the last step
+ */
+void AVLTree::_extendFinger(const int id)
+{
+    while (true)
     {
-        Node* leftmost = _getLeftmost(right);
-        root->id = leftmost->id;
-        root->name = leftmost->name;
-        delete leftmost;
+        const FingerStep step = _finger.back();
+        Node* node = step.node;
+        if (id == node->id) return;
+        if (id < node->id)
+        {
+            if (!node->left) return;
+            _finger.push_back({node->left, step.lower, node});
+        }
+        else
+        {
+            if (!node->right) return;
+            _finger.push_back({node->right, node, step.upper});
+        }
     }
+}
 
-    return root;
+/**
+ *  @brief  Complete a spine of @c this tree down to its leftmost or rightmost @c Node, starting over from the root
+ *          unless the spine is still anchored there
+ *  @param  spine  path from the root along the left or right children
+ *  @param  is_left  whether the spine follows the left children
+ *  @complexity O(log n) (worst-case); O(d) (worst-case) for the d missing steps of an anchored spine
+ */
+void AVLTree::_buildSpine(vector<Node*>& spine, const bool is_left)
+{
+    if (spine.empty() || spine[0] != _root) spine.clear();
+    if (!_root) return;
+    if (spine.empty()) spine.push_back(_root);
+
+    for (Node* next = is_left ? spine.back()->left : spine.back()->right; next;
+         next = is_left ? next->left : next->right)
+        spine.push_back(next);
+}
+
+/**
+ *  @brief  Unlink the leftmost or rightmost @c Node of @c this tree, rebalancing only along its spine
+ *  @param  spine  complete path from the root to the @c Node
+ *  @param  is_left  whether the spine follows the left children
+ *  @return pointer to the unlinked @c Node; the spine is completed again to the new extreme @c Node
+ *  @note   rebalancing stops at the first ancestor whose height and shape are unchanged; a rotation moves
+ *          @c Nodes of the spine, which is then rebuilt from above the highest rotation
+ *  @complexity O(1) (amortized) over a sequence of pops; O(log n) (worst-case)
+ */
+Node* AVLTree::_popSpine(vector<Node*>& spine, const bool is_left)
+{
+    Node* extreme = spine.back();
+    spine.pop_back();
+    Node* orphan = is_left ? extreme->right : extreme->left; // the one child an extreme Node can have
+    if (spine.empty()) _root = orphan; else
+    if (is_left) spine.back()->left = orphan; else spine.back()->right = orphan;
+
+    size_t valid = spine.size();
+    for (size_t i = spine.size(); i-- > 0;)
+    {
+        Node* ancestor = spine[i];
+        const int height = ancestor->height;
+        Node* balanced = _updateBalance(ancestor);
+        if (balanced != ancestor)
+        {
+            if (!i) _root = balanced; else
+            if (is_left) spine[i - 1]->left = balanced; else spine[i - 1]->right = balanced;
+            valid = i;
+        }
+        else if (ancestor->height == height) break;
+    }
+
+    spine.resize(valid);
+    _buildSpine(spine, is_left);
+    if (!valid) (is_left ? _rightSpine : _leftSpine).clear(); // a rotation at the root moved the other spine
+    return extreme;
+}
+
+/**
+ *  @brief Copy the @c Nodes at a depth below the root of a tree, from left to right, to a list
+ *  @param root  pointer to the root @c Node of the tree
+ *  @param depth  number of levels below the root
+ *  @param nodes  list to which pointers to the @c Nodes are copied
+ */
+void AVLTree::_collectLevel(Node* root, const int depth, vector<Node*>& nodes)
+{
+    if (!root) return;
+    if (!depth) { nodes.push_back(root); return; }
+
+    _collectLevel(root->left, depth - 1, nodes);
+    _collectLevel(root->right, depth - 1, nodes);
+}
+
+/**
+ *  @brief Copy the @c Nodes of the top levels of a tree, in van Emde Boas order, to a list
+ *  @param root  pointer to the root @c Node of the tree
+ *  @param levels  number of levels, from the root, to be copied
+ *  @param order  list to which pointers to the @c Nodes are copied
+ *  @note  the top half of the levels is laid out recursively, followed by each subtree hanging below it,
+ *         so that any root-to-leaf path crosses O(log_B n) blocks of B @c Nodes for every block size B
+ *  @complexity O(n log log n) (worst-case)
+ */
+void AVLTree::_orderVanEmdeBoas(Node* root, const int levels, vector<Node*>& order)
+{
+    if (!root || levels <= 0) return;
+    if (levels == 1) { order.push_back(root); return; }
+
+    const int top_levels = levels / 2;
+    _orderVanEmdeBoas(root, top_levels, order);
+
+    vector<Node*> subtrees;
+    _collectLevel(root, top_levels, subtrees);
+    for (Node* subtree : subtrees) _orderVanEmdeBoas(subtree, levels - top_levels, order);
 }
 
 /**
@@ -238,7 +940,7 @@ Node* AVLTree::_deleteNode(Node* root, Node* parent)
  *  @param  id integer ID
  *  @return 8-character string representing the integer ID
  */
-string AVLTree::_idToString(const int id)
+string AVLTree::idToString(const int id)
 {
     string prefix;
     string id_string = to_string(id);
@@ -328,21 +1030,124 @@ void AVLTree::_copyLevelorder(Node* root, string& names)
 }
 
 /**
- *  @brief  Create, with ID and name, and insert a @c Node to a tree
- *  @param  root  pointer to the root @c Node of the tree
- *  @param  id  integer ID
- *  @param  name full name
+ *  @brief Split a depth-first traversal into the top @c Nodes, each copied to its own buffer, and the subtrees
+ *         below them shorter than @c PARALLEL_SCAN_HEIGHT, each left with an empty buffer, in traversal order
+ *  @param root  pointer to the root @c Node of a tree
+ *  @param type  @c INORDER, @c PREORDER or @c POSTORDER
+ *  @param subtrees  list to which the subtree of each buffer is copied; @c nullptr for a copied @c Node
+ *  @param buffers  list to which the buffers are added
+ */
+void AVLTree::_splitTraversal(Node* root, const int type, vector<Node*>& subtrees, vector<string>& buffers)
+{
+    if (_getHeight(root) < PARALLEL_SCAN_HEIGHT)
+    {
+        subtrees.push_back(root);
+        buffers.emplace_back();
+        return;
+    }
+
+    if (type == PREORDER) { subtrees.push_back(nullptr); buffers.push_back(root->name + ", "); }
+    _splitTraversal(root->left, type, subtrees, buffers);
+    if (type == INORDER) { subtrees.push_back(nullptr); buffers.push_back(root->name + ", "); }
+    _splitTraversal(root->right, type, subtrees, buffers);
+    if (type == POSTORDER) { subtrees.push_back(nullptr); buffers.push_back(root->name + ", "); }
+}
+
+/**
+ *  @brief Copies a comma-separated levelorder traversal to buffers, splitting wide levels across a pool
+ *  @param root  pointer to the root @c Node of a tree
+ *  @param buffers  list to which the buffers are added, in levelorder
+ *  @param pool  pool onto which chunks of @c PARALLEL_LEVEL_GRAIN @c Nodes of a level are forked
+ */
+void AVLTree::_copyLevelorderParallel(Node* root, vector<string>& buffers, ThreadPool& pool)
+{
+    vector<Node*> level;
+    if (root) level.push_back(root);
+    while (!level.empty())
+    {
+        const size_t chunk_count = (level.size() + PARALLEL_LEVEL_GRAIN - 1) / PARALLEL_LEVEL_GRAIN;
+        vector<vector<Node*>> next_levels(chunk_count);
+        const size_t first_buffer = buffers.size();
+        buffers.resize(first_buffer + chunk_count);
+
+        vector<shared_ptr<ThreadPool::Task>> tasks;
+        for (size_t chunk = 0; chunk < chunk_count; chunk++)
+        {
+            std::function<void()> copy = [&, chunk]()
+            {
+                string& names = buffers[first_buffer + chunk];
+                vector<Node*>& next_level = next_levels[chunk];
+                const size_t last = std::min(level.size(), (chunk + 1) * PARALLEL_LEVEL_GRAIN);
+                for (size_t i = chunk * PARALLEL_LEVEL_GRAIN; i < last; i++)
+                {
+                    names += (level[i]->name + ", ");
+                    if (level[i]->left) next_level.push_back(level[i]->left);
+                    if (level[i]->right) next_level.push_back(level[i]->right);
+                }
+            };
+            if (chunk + 1 < chunk_count) tasks.push_back(pool.fork(copy));
+            else copy();
+        }
+        for (const shared_ptr<ThreadPool::Task>& task : tasks) pool.join(task);
+
+        level.clear();
+        for (const vector<Node*>& next_level : next_levels) level.insert(level.end(), next_level.begin(), next_level.end());
+    }
+}
+
+/**
+ *  @brief Concatenate buffers into one string, copying groups of about @c PARALLEL_COPY_GRAIN bytes on a pool
+ *  @param buffers  list of strings, emptied as they are copied
+ *  @param pool  pool onto which the groups are forked
+ *  @return concatenation of the buffers
+ *  @complexity O(n) work, O(n / p + k) span for p threads and k buffers
+ */
+string AVLTree::_assemble(vector<string>& buffers, ThreadPool& pool)
+{
+    size_t length = 0;
+    for (const string& buffer : buffers) length += buffer.size();
+    string names(length, '\0');
+    char* const output = &names[0]; // tasks copy raw bytes, since no member of the string may be called concurrently
+
+    vector<shared_ptr<ThreadPool::Task>> tasks;
+    size_t offset = 0;
+    for (size_t first = 0; first < buffers.size();)
+    {
+        size_t last = first;
+        size_t group_length = 0;
+        while (last < buffers.size() && group_length < PARALLEL_COPY_GRAIN) group_length += buffers[last++].size();
+        tasks.push_back(pool.fork([output, &buffers, first, last, offset]()
+        {
+            size_t position = offset;
+            for (size_t i = first; i < last; i++)
+            {
+                std::copy(buffers[i].begin(), buffers[i].end(), output + position);
+                position += buffers[i].size();
+                string().swap(buffers[i]);
+            }
+        }));
+        offset += group_length;
+        first = last;
+    }
+    for (const shared_ptr<ThreadPool::Task>& task : tasks) pool.join(task);
+    return names;
+}
+
+/**
+ *  @brief  Insert a @c Node to a tree
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  node  pointer to the @c Node
  *  @return pointer to the root @c Node of the updated tree
  *  @complexity O(log n) (worst-case)
  */
-Node* AVLTree::_insert(Node* root, const int id, const string& name)
+Node* AVLTree::_insert(Node* root, Node* node)
 {
-    if (root == nullptr) return new Node(id, name);
+    if (root == nullptr) return node;
 
     const int root_id = root->id;
 
-    if (id < root_id) root->left = _insert(root->left, id, name);
-    else root->right = _insert(root->right, id, name);
+    if (node->id < root_id) _storeLink(root->left, _insert(root->left, node));
+    else _storeLink(root->right, _insert(root->right, node));
 
     root = _updateBalance(root);
 
@@ -350,50 +1155,296 @@ Node* AVLTree::_insert(Node* root, const int id, const string& name)
 }
 
 /**
- *  @brief  Identify, by ID, and remove a @c Node from a tree
+ *  @brief  Merge a batch of @c Nodes, sorted by and unique in ID, into a tree by divide and conquer
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  batch  array of pointers to the @c Nodes to be inserted
+ *  @param  count  number of @c Nodes in the batch
+ *  @param  is_rejected  array of flags set for the @c Nodes whose ID already exists in the tree
+ *  @return pointer to the root @c Node of the updated tree
+ *  @complexity O(k log(n/k + 1)) (worst-case)
+ */
+Node* AVLTree::_insertBatch(Node* root, Node** batch, const size_t count, bool* is_rejected)
+{
+    if (!count) return root;
+    if (!root) return _link(batch, count);
+
+    const int root_id = root->id;
+    Node** split = lower_bound(batch, batch + count, root_id,
+                               [](const Node* node, const int id) { return node->id < id; });
+    const size_t left_count = split - batch;
+    size_t right_first = left_count;
+    if (right_first < count && batch[right_first]->id == root_id) is_rejected[right_first++] = true;
+
+    Node* left = _insertBatch(root->left, batch, left_count, is_rejected);
+    Node* right = _insertBatch(root->right, batch + right_first, count - right_first, is_rejected + right_first);
+    return _join(left, root, right);
+}
+
+/**
+ *  @brief  Merge a batch of @c Nodes, sorted by and unique in ID, into a tree by flattening and relinking it
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  batch  array of pointers to the @c Nodes to be inserted
+ *  @param  count  number of @c Nodes in the batch
+ *  @param  is_rejected  array of flags set for the @c Nodes whose ID already exists in the tree
+ *  @return pointer to the root @c Node of the updated tree
+ *  @complexity O(n + k) (worst-case)
+ */
+Node* AVLTree::_mergeBatch(Node* root, Node** batch, const size_t count, bool* is_rejected)
+{
+    vector<Node*> nodes;
+    _flatten(root, nodes);
+
+    vector<Node*> merged;
+    merged.reserve(nodes.size() + count);
+    size_t i = 0, j = 0;
+    while (i < nodes.size() || j < count)
+    {
+        if (j == count || (i < nodes.size() && nodes[i]->id < batch[j]->id)) merged.push_back(nodes[i++]);
+        else
+        if (i == nodes.size() || batch[j]->id < nodes[i]->id) merged.push_back(batch[j++]);
+        else
+        {
+            merged.push_back(nodes[i++]);
+            is_rejected[j++] = true;
+        }
+    }
+    return _link(merged.data(), merged.size());
+}
+
+/**
+ *  @brief  Merge two trees into the tree of the IDs found in either, by divide and conquer
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  other  pointer to the root @c Node of the other tree
+ *  @param  policy  @c Conflict policy choosing which of two @c Nodes sharing an ID is kept
+ *  @param  discards  list to which pointers to the @c Nodes not kept are copied
+ *  @param  pool  pool onto which recursive halves of large trees are forked; @c nullptr to run sequentially
+ *  @return pointer to the root @c Node of the merged tree
+ *  @complexity O(m log(n/m + 1)) work, O(log^2 n) span (worst-case)
+ */
+Node* AVLTree::_union(Node* root, Node* other, const int policy, vector<Node*>& discards, ThreadPool* pool)
+{
+    if (!root) return other;
+    if (!other) return root;
+
+    const bool is_forked = pool && std::min(_getHeight(root), _getHeight(other)) >= PARALLEL_SET_HEIGHT;
+    Node* root_left = root->left;
+    Node* root_right = root->right;
+    Node* other_left = nullptr;
+    Node* other_right = nullptr;
+    Node* match = _split(other, root->id, other_left, other_right);
+
+    Node* pivot = root;
+    if (match && policy == KEEP_OTHER) { pivot = match; discards.push_back(root); }
+    else if (match) discards.push_back(match);
+
+    Node* left = nullptr;
+    Node* right = nullptr;
+    if (is_forked)
+    {
+        vector<Node*> right_discards;
+        shared_ptr<ThreadPool::Task> task = pool->fork([&]()
+        {
+            right = _union(root_right, other_right, policy, right_discards, pool);
+        });
+        left = _union(root_left, other_left, policy, discards, pool);
+        pool->join(task);
+        discards.insert(discards.end(), right_discards.begin(), right_discards.end());
+    }
+    else
+    {
+        left = _union(root_left, other_left, policy, discards, pool);
+        right = _union(root_right, other_right, policy, discards, pool);
+    }
+    return _join(left, pivot, right);
+}
+
+/**
+ *  @brief  Merge two trees into the tree of the IDs found in both, by divide and conquer
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  other  pointer to the root @c Node of the other tree
+ *  @param  policy  @c Conflict policy choosing which of two @c Nodes sharing an ID is kept
+ *  @param  discards  list to which pointers to the @c Nodes not kept are copied
+ *  @param  pool  pool onto which recursive halves of large trees are forked; @c nullptr to run sequentially
+ *  @return pointer to the root @c Node of the merged tree
+ *  @complexity O(m log(n/m + 1)) work, O(log^2 n) span (worst-case)
+ */
+Node* AVLTree::_intersect(Node* root, Node* other, const int policy, vector<Node*>& discards, ThreadPool* pool)
+{
+    if (!root || !other)
+    {
+        _flatten(root, discards);
+        _flatten(other, discards);
+        return nullptr;
+    }
+
+    const bool is_forked = pool && std::min(_getHeight(root), _getHeight(other)) >= PARALLEL_SET_HEIGHT;
+    Node* root_left = root->left;
+    Node* root_right = root->right;
+    Node* other_left = nullptr;
+    Node* other_right = nullptr;
+    Node* match = _split(other, root->id, other_left, other_right);
+
+    Node* left = nullptr;
+    Node* right = nullptr;
+    if (is_forked)
+    {
+        vector<Node*> right_discards;
+        shared_ptr<ThreadPool::Task> task = pool->fork([&]()
+        {
+            right = _intersect(root_right, other_right, policy, right_discards, pool);
+        });
+        left = _intersect(root_left, other_left, policy, discards, pool);
+        pool->join(task);
+        discards.insert(discards.end(), right_discards.begin(), right_discards.end());
+    }
+    else
+    {
+        left = _intersect(root_left, other_left, policy, discards, pool);
+        right = _intersect(root_right, other_right, policy, discards, pool);
+    }
+
+    if (!match)
+    {
+        discards.push_back(root);
+        return _concatenate(left, right);
+    }
+    Node* pivot = root;
+    if (policy == KEEP_OTHER) { pivot = match; discards.push_back(root); }
+    else discards.push_back(match);
+    return _join(left, pivot, right);
+}
+
+/**
+ *  @brief  Merge two trees into the tree of the IDs found in the first but not in the other, by divide and conquer
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  other  pointer to the root @c Node of the other tree
+ *  @param  discards  list to which pointers to the @c Nodes not kept are copied
+ *  @param  pool  pool onto which recursive halves of large trees are forked; @c nullptr to run sequentially
+ *  @return pointer to the root @c Node of the merged tree
+ *  @complexity O(m log(n/m + 1)) work, O(log^2 n) span (worst-case)
+ */
+Node* AVLTree::_difference(Node* root, Node* other, vector<Node*>& discards, ThreadPool* pool)
+{
+    if (!root || !other)
+    {
+        _flatten(other, discards);
+        return root;
+    }
+
+    const bool is_forked = pool && std::min(_getHeight(root), _getHeight(other)) >= PARALLEL_SET_HEIGHT;
+    Node* other_left = other->left;
+    Node* other_right = other->right;
+    Node* root_left = nullptr;
+    Node* root_right = nullptr;
+    Node* match = _split(root, other->id, root_left, root_right);
+    if (match) discards.push_back(match);
+    discards.push_back(other);
+
+    Node* left = nullptr;
+    Node* right = nullptr;
+    if (is_forked)
+    {
+        vector<Node*> right_discards;
+        shared_ptr<ThreadPool::Task> task = pool->fork([&]()
+        {
+            right = _difference(root_right, other_right, right_discards, pool);
+        });
+        left = _difference(root_left, other_left, discards, pool);
+        pool->join(task);
+        discards.insert(discards.end(), right_discards.begin(), right_discards.end());
+    }
+    else
+    {
+        left = _difference(root_left, other_left, discards, pool);
+        right = _difference(root_right, other_right, discards, pool);
+    }
+    return _concatenate(left, right);
+}
+
+/**
+ *  @brief  Identify, by ID, and unlink a @c Node from a tree
  *  @param  root  pointer to the root @c Node of the tree
- *  @param  parent  pointer to the parent of the root @c Node
  *  @param  id integer ID
- *  @return boolean indicating whether a node was removed
+ *  @param  removal  pointer to which the unlinked @c Node is copied; left unchanged if the ID is not found
+ *  @return pointer to the root @c Node of the updated tree
  *  @complexity O(log n) (worst-case)
  */
-bool AVLTree::_remove(Node* root, Node* parent, const int id)
+Node* AVLTree::_remove(Node* root, const int id, Node*& removal)
 {
-    if (!root) return false;
-    int root_id = root->id;
-    bool left_is_removed = false, current_is_removed = false, right_is_removed = false;
-    if (id < root_id) left_is_removed = _remove(root->left, root, id); else
-    if (id > root_id) right_is_removed = _remove(root->right, root, id); else
+    if (!root) return nullptr;
+
+    const int root_id = root->id;
+    if (id < root_id) _storeLink(root->left, _remove(root->left, id, removal)); else
+    if (id > root_id) _storeLink(root->right, _remove(root->right, id, removal)); else
     {
-        root = _deleteNode(root, parent);
-        current_is_removed = true;
-        if (root) _updateHeight(root);
+        removal = root;
+        return _unlink(root);
     }
-    return (left_is_removed || current_is_removed || right_is_removed);
+    return _updateBalance(root);
 }
 
 /**
- *  @brief  Identify, by inorder count, and remove a @c Node from a tree
+ *  @brief  Identify, by inorder count, and unlink a @c Node from a tree
  *  @param  root  pointer to the root @c Node of the tree
- *  @param  parent  pointer to the parent of the root @c Node
  *  @param  count pointer to a counter that preserves its state through recursive calls
- *  @return boolean indicating whether a node was removed
- *  @complexity O(log n) (worst-case)
+ *  @param  removal  pointer to which the unlinked @c Node is copied; left unchanged if the count is out of bounds
+ *  @return pointer to the root @c Node of the updated tree
+ *  @complexity O(n) (worst-case)
  */
-bool AVLTree::_removeInorder(Node* root, Node* parent, int* count)
+Node* AVLTree::_removeInorder(Node* root, int* count, Node*& removal)
 {
-    if (!root) return false;
-    bool left_is_removed = _removeInorder(root->left, root, count);
-    bool current_is_removed = false;
-    if (!((*count)--))
+    if (!root) return nullptr;
+
+    _storeLink(root->left, _removeInorder(root->left, count, removal));
+    if (!removal && !((*count)--))
     {
-        root = _deleteNode(root, parent);
-        if (root) _updateHeight(root);
-        current_is_removed = true;
+        removal = root;
+        return _unlink(root);
     }
-    bool right_is_removed = false;
-    if (root) right_is_removed = _removeInorder(root->right, root, count);
-    return (left_is_removed || current_is_removed || right_is_removed);
+    if (!removal) _storeLink(root->right, _removeInorder(root->right, count, removal));
+    return _updateBalance(root);
+}
+
+/**
+ *  @brief  Unlink from a tree the @c Nodes with IDs in a sorted list, in one pass over both
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  ids  array of integer IDs, sorted
+ *  @param  count  number of IDs in the array
+ *  @param  removals  list to which the unlinked @c Nodes are copied
+ *  @return pointer to the root @c Node of the updated tree
+ *  @note   the IDs are partitioned around each root visited, so subtrees without any listed ID are not entered
+ *  @complexity O(k log(n/k + 1)) (worst-case)
+ */
+Node* AVLTree::_removeBatch(Node* root, const int* ids, const size_t count, vector<Node*>& removals)
+{
+    if (!root || !count) return root;
+
+    const int* pivot = lower_bound(ids, ids + count, root->id);
+    const size_t left_count = pivot - ids;
+    const bool is_match = (left_count < count && *pivot == root->id);
+    Node* left = _removeBatch(root->left, ids, left_count, removals);
+    Node* right = _removeBatch(root->right, pivot + is_match, count - left_count - is_match, removals);
+    if (!is_match) return _join(left, root, right);
+
+    removals.push_back(root);
+    return _concatenate(left, right);
+}
+
+/**
+ *  @brief  Identify, by inorder count, a @c Node of a tree
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  count  inorder count, decreased by the number of @c Nodes passed over
+ *  @return pointer to the @c Node; @c nullptr if the count is out of bounds
+ *  @complexity O(n) (worst-case)
+ */
+Node* AVLTree::_selectInorder(Node* root, int& count)
+{
+    if (!root) return nullptr;
+
+    Node* match = _selectInorder(root->left, count);
+    if (match) return match;
+    if (!(count--)) return root;
+    return _selectInorder(root->right, count);
 }
 
 /**
@@ -424,12 +1475,221 @@ void AVLTree::_search(Node* root, const string& name, vector<string>& matches)
 {
     if (!root) return;
 
-    const string root_name = root->name;
-    if (name == root_name) matches.push_back(_idToString(root->id));
+    if (name == root->name) matches.push_back(idToString(root->id));
     _search(root->left, name, matches);
     _search(root->right, name, matches);
 }
 
+/**
+ *  @brief Search, by name, a tree with its large right subtrees scanned on a pool, in preorder
+ *  @param root  pointer to the root @c Node of the tree
+ *  @param name  full name
+ *  @param matches vector to which list of IDs is to be copied
+ *  @param pool  pool onto which the right subtrees taller than @c PARALLEL_SCAN_HEIGHT are forked
+ *  @note  a forked subtree fills its own list, appended after the list of its left sibling, so the IDs come
+ *         out in the order of @c _search
+ *  @complexity O(n) work, O(log n + n / p) span for p threads (worst-case)
+ */
+void AVLTree::_searchParallel(Node* root, const string& name, vector<string>& matches, ThreadPool& pool)
+{
+    if (_getHeight(root) < PARALLEL_SCAN_HEIGHT) return _search(root, name, matches);
+
+    if (name == root->name) matches.push_back(idToString(root->id));
+    vector<string> right_matches;
+    shared_ptr<ThreadPool::Task> task = pool.fork([&]()
+    {
+        _searchParallel(root->right, name, right_matches, pool);
+    });
+    _searchParallel(root->left, name, matches, pool);
+    pool.join(task);
+    matches.insert(matches.end(), std::make_move_iterator(right_matches.begin()),
+                   std::make_move_iterator(right_matches.end()));
+}
+
+/**
+ *  @brief Search, by ID, a group of IDs at once and copy the names of matching @c Nodes from a tree
+ *  @param root  pointer to the root @c Node of the tree
+ *  @param ids  array of integer IDs
+ *  @param count  number of IDs in the array
+ *  @param matches  array to which the name of each found ID is copied, at the index of the ID
+ *  @note  lookups advance one level per round across a group of @c SEARCH_GROUP_SIZE cursors, so the
+ *         next child of every cursor is prefetched while the other cursors of the group are compared
+ *  @complexity O(k log n) (worst-case)
+ */
+void AVLTree::_searchBatch(Node* root, const int* ids, const size_t count, string* matches)
+{
+    Node* cursors[SEARCH_GROUP_SIZE];
+
+    for (size_t first = 0; first < count; first += SEARCH_GROUP_SIZE)
+    {
+        const size_t group_size = (count - first < SEARCH_GROUP_SIZE) ? count - first : SEARCH_GROUP_SIZE;
+        for (size_t i = 0; i < group_size; i++) cursors[i] = root;
+
+        bool is_active = (root != nullptr);
+        while (is_active) // one level of the tree per round
+        {
+            is_active = false;
+            for (size_t i = 0; i < group_size; i++)
+            {
+                Node* current = cursors[i];
+                if (!current) continue;
+
+                const int id = ids[first + i];
+                const int current_id = current->id;
+                if (id == current_id)
+                {
+                    matches[first + i] = current->name;
+                    cursors[i] = nullptr;
+                    continue;
+                }
+
+                Node* next = (id < current_id) ? current->left : current->right;
+                if (next) { AVL_PREFETCH(next); is_active = true; }
+                cursors[i] = next;
+            }
+        }
+    }
+}
+
+/**
+ *  @brief  Create a deep copy of another tree, as @c clone does
+ *  @param  other  tree
+ */
+AVLTree::AVLTree(const AVLTree& other) : AVLTree(other.clone()) {}
+
+/**
+ *  @brief  Create a tree taking over the @c Nodes, arenas and indexes of another, which is left empty
+ *  @param  other  tree
+ *  @note   frees stay deferred on the other tree, which keeps the arenas of its outstanding retired @c Nodes
+ */
+AVLTree::AVLTree(AVLTree&& other) noexcept :
+        _root(other._root), _arenas(other._takeArenas()), _presence(std::move(other._presence)),
+        _hash(std::move(other._hash)), _finger(std::move(other._finger)), _leftSpine(std::move(other._leftSpine)),
+        _rightSpine(std::move(other._rightSpine))
+{
+    other._root = nullptr;
+    other._dropCursors();
+}
+
+/**
+ *  @brief  Free the @c Nodes of @c this tree and replace them with a deep copy of another tree
+ *  @param  other  tree
+ *  @return reference to @c this tree
+ */
+AVLTree& AVLTree::operator=(const AVLTree& other)
+{
+    if (this != &other) *this = other.clone();
+    return *this;
+}
+
+/**
+ *  @brief  Free the @c Nodes of @c this tree and take over those of another, which is left empty
+ *  @param  other  tree
+ *  @return reference to @c this tree
+ *  @note   while frees are deferred on @c this tree, its @c Nodes are retired rather than freed; deferral
+ *          stays with each tree, as do the arenas of its outstanding retired @c Nodes
+ */
+AVLTree& AVLTree::operator=(AVLTree&& other) noexcept
+{
+    if (this == &other) return *this;
+
+    _releaseAll();
+    _root = other._root;
+    _arenas = other._takeArenas();
+    _presence = std::move(other._presence);
+    _hash = std::move(other._hash);
+    _finger = std::move(other._finger);
+    _leftSpine = std::move(other._leftSpine);
+    _rightSpine = std::move(other._rightSpine);
+    other._root = nullptr;
+    other._dropCursors();
+    return *this;
+}
+
+/**
+ *  @brief  Free every @c Node of @c this tree, on the background thread of @c NodeReleaser if it is large
+ *  @note   frees deferred by @c deferFrees are not waited for; the owner releases its retired @c Nodes first
+ */
+AVLTree::~AVLTree()
+{
+    _retired = nullptr;
+    _releaseAll();
+}
+
+/**
+ *  @brief  Create a deep copy of @c this tree with the same shape and, for @c Nodes held by arenas, the same
+ *          layout, along with copies of its indexes
+ *  @param  pool  pool onto which the right subtrees of large trees are forked; @c nullptr to copy sequentially
+ *  @return copy, sharing no @c Node, arena or index with @c this tree
+ *  @note   the copy reserves arenas as large as those @c this tree shares, even with the trees split from it
+ *  @complexity O(n) work, O(log n + n / p) span for p threads (worst-case)
+ */
+AVLTree AVLTree::clone(ThreadPool* pool) const
+{
+    AVLTree copy;
+    for (const shared_ptr<NodeArena>& arena : _arenas) copy._arenas.push_back(make_shared<NodeArena>(arena->capacity));
+    copy._root = _cloneSubtree(_root, _arenas, copy._arenas, pool);
+    if (_hash)
+    {
+        copy._hash = make_shared<HashIndex>();
+        copy._indexSubtree(copy._root, true);
+    }
+    if (_presence) copy._presence = make_shared<PresenceBitmap>(*_presence);
+    return copy;
+}
+
+/**
+ *  @brief  Remove every @c Node from @c this tree, keeping its indexes enabled; large trees are freed on a
+ *          background thread, so the call returns without walking them
+ *  @complexity O(1) for large trees, O(n) for small ones, plus the clearing of any index (worst-case)
+ */
+void AVLTree::clear()
+{
+    _releaseAll();
+    _rebuildIndexes();
+}
+
+/**
+ *  @brief  Create a perfectly balanced tree from a sequence of ID and name pairs
+ *  @param  first  iterator to the first pair
+ *  @param  last  iterator past the last pair
+ *  @return tree containing the pairs; a sequence that is not sorted by and unique in ID
+ *          is instead merged as by @c insertBatch
+ *  @complexity O(n) (worst-case) for sorted input
+ */
+template <typename Iterator>
+AVLTree AVLTree::buildFromSorted(Iterator first, Iterator last)
+{
+    AVLTree tree;
+    typedef typename std::iterator_traits<Iterator>::reference Reference;
+    if (adjacent_find(first, last, [](Reference a, Reference b) { return !(a.first < b.first); }) == last)
+        tree._root = _buildSorted(first, std::distance(first, last));
+    else
+        tree.insertBatch(vector<pair<int, string>>(first, last));
+    return tree;
+}
+
+/**
+ *  @brief  Create a perfectly balanced tree from a sequence of ID and name pairs, building subtrees on a thread pool
+ *  @param  first  random-access iterator to the first pair
+ *  @param  last  random-access iterator past the last pair
+ *  @param  pool  pool onto which the builds of large subtrees are forked
+ *  @return tree containing the pairs; a sequence that is not sorted by and unique in ID
+ *          is instead merged as by @c insertBatch
+ *  @complexity O(n) work, O(log n + n / p) span for p threads (worst-case) for sorted input
+ */
+template <typename Iterator>
+AVLTree AVLTree::buildFromSortedParallel(Iterator first, Iterator last, ThreadPool& pool)
+{
+    AVLTree tree;
+    typedef typename std::iterator_traits<Iterator>::reference Reference;
+    if (adjacent_find(first, last, [](Reference a, Reference b) { return !(a.first < b.first); }) == last)
+        tree._root = _buildSortedParallel(first, last - first, pool);
+    else
+        tree.insertBatch(vector<pair<int, string>>(first, last));
+    return tree;
+}
+
 /**
  *  @brief  Get a comma-separated list of names from nodes in @c this tree
  *  @param  type type of tree traversal to generate the list from
@@ -455,6 +1715,45 @@ string AVLTree::traversalToString(const Traversal type)
     return names;
 }
 
+/**
+ *  @brief  Get a comma-separated list of names from @c this tree, rendering subtrees to buffers on a pool
+ *  @param  type  type of tree traversal to generate the list from
+ *  @param  pool  pool onto which subtrees, or chunks of wide levels, and then the concatenation are forked
+ *  @return comma-separated list of names as a string, identical to that of @c traversalToString(type)
+ *  @complexity O(n) work, O(n / p + log n) span for p threads
+ */
+string AVLTree::traversalToString(const Traversal type, ThreadPool& pool)
+{
+    if (!_root) return "";
+    vector<string> buffers;
+
+    if (type == LEVELORDER) _copyLevelorderParallel(_root, buffers, pool);
+    else
+    {
+        vector<Node*> subtrees;
+        _splitTraversal(_root, type, subtrees, buffers);
+        vector<shared_ptr<ThreadPool::Task>> tasks;
+        for (size_t i = 0; i < subtrees.size(); i++)
+        {
+            if (!subtrees[i]) continue;
+            tasks.push_back(pool.fork([&subtrees, &buffers, type, i]()
+            {
+                switch (type)
+                {
+                    case INORDER: _copyInorder(subtrees[i], buffers[i]); break;
+                    case PREORDER: _copyPreorder(subtrees[i], buffers[i]); break;
+                    default: _copyPostorder(subtrees[i], buffers[i]);
+                }
+            }));
+        }
+        for (const shared_ptr<ThreadPool::Task>& task : tasks) pool.join(task);
+    }
+
+    string names = _assemble(buffers, pool);
+    names.resize(names.size() - 2); // removes the last comma and space
+    return names;
+}
+
 /**
  *  @brief  Get the number of levels from root to most distant leaf of @c this tree
  *  @return highest level of @c this tree
@@ -502,10 +1801,291 @@ int AVLTree::levelCount()
  */
 bool AVLTree::insert(const int id, const string& name)
 {
-    if (!search(id).empty()) return false;
-    Node* root = _insert(_root, id, name);
-    if (root != nullptr) _root = root;
-    return root != nullptr;
+    if (_hash)
+    {
+        if (_hash->find(id)) return false;
+    }
+    else
+    if (_presence && PresenceBitmap::inDomain(id))
+    {
+        if (_presence->test(id)) return false; // rejected without descending the tree
+    }
+    else if (!search(id).empty()) return false;
+
+    Node* node = new Node(id, name);
+    _storeLink(_root, _insert(_root, node));
+    _indexInsert(node);
+    _dropCursors();
+    return true;
+}
+
+/**
+ *  @brief  Create, with ID and name, and insert a @c Node to @c this tree, starting from a nearby ID
+ *  @param  hint  integer ID near the new one, such as the previously inserted ID; the finger of @c this tree
+ *          is moved there first unless it already rests there
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the node was inserted successfully; the finger rests on the @c Node
+ *          with the ID either way
+ *  @note   the finger climbs only until the subtree under it spans the ID, and rebalancing stops at the first
+ *          ancestor whose height is unchanged, so inserting next to the hint, or appending past the maximum,
+ *          takes amortized constant time
+ *  @complexity O(log d) (amortized), for the number d of IDs between the hint and the ID
+ */
+bool AVLTree::insertHint(const int hint, const int id, const string& name)
+{
+    if (_finger.empty() || _finger[0].node != _root || _finger.back().node->id != hint) _seekFinger(hint);
+    _leftSpine.clear();
+    _rightSpine.clear();
+    if (!_root)
+    {
+        _root = new Node(id, name);
+        _indexInsert(_root);
+        _finger.push_back({_root, nullptr, nullptr});
+        return true;
+    }
+
+    while (_finger.size() > 1)
+    {
+        const FingerStep& step = _finger.back();
+        if ((!step.lower || step.lower->id < id) && (!step.upper || id < step.upper->id)) break;
+        _finger.pop_back();
+    }
+    _extendFinger(id);
+    const FingerStep parent = _finger.back();
+    if (parent.node->id == id) return false;
+
+    Node* node = new Node(id, name);
+    if (id < parent.node->id) parent.node->left = node; else parent.node->right = node;
+    _finger.push_back(id < parent.node->id ? FingerStep{node, parent.lower, parent.node}
+                                           : FingerStep{node, parent.node, parent.upper});
+    _indexInsert(node);
+
+    for (size_t i = _finger.size() - 1; i-- > 0;)
+    {
+        Node* ancestor = _finger[i].node;
+        const int height = ancestor->height;
+        Node* balanced = _updateBalance(ancestor);
+        if (balanced != ancestor)
+        {
+            // a rotation restores the height the subtree had before the insertion, so no ancestor above changes
+            Node* above = i ? _finger[i - 1].node : nullptr;
+            if (!above) _root = balanced; else
+            if (above->left == ancestor) above->left = balanced; else above->right = balanced;
+            _finger.resize(i);
+            if (_finger.empty()) _finger.push_back({_root, nullptr, nullptr});
+            _extendFinger(id);
+            break;
+        }
+        if (ancestor->height == height) break;
+    }
+    return true;
+}
+
+/**
+ *  @brief  Create, with IDs and names, and insert a batch of @c Nodes to @c this tree
+ *  @param  entries  list of pairs of integer ID and full name, in any order
+ *  @return list of booleans indicating whether each entry was inserted, in the order of the entries;
+ *          as with repeated calls to @c insert, only the first of several entries sharing an ID is inserted
+ *  @complexity O(k log(n/k + 1) + k log k) (worst-case)
+ */
+vector<bool> AVLTree::insertBatch(vector<pair<int, string>>&& entries)
+{
+    const size_t count = entries.size();
+    vector<bool> results(count, false);
+
+    vector<size_t> order(count);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(),
+                [&entries](const size_t a, const size_t b) { return entries[a].first < entries[b].first; });
+
+    vector<Node*> batch;
+    vector<size_t> positions;
+    for (size_t position : order)
+    {
+        const int id = entries[position].first;
+        if (!batch.empty() && batch.back()->id == id) continue; // a preceding entry shares the ID
+        batch.push_back(new Node(id, std::move(entries[position].second)));
+        positions.push_back(position);
+    }
+
+    // a batch that is a sizable fraction of the tree is cheaper to merge in one sequential pass
+    std::unique_ptr<bool[]> is_rejected(new bool[batch.size()]());
+    _dropCursors();
+    if (_root && (batch.size() << 2) >= (size_t(1) << std::min(_root->height, 40)))
+        _root = _mergeBatch(_root, batch.data(), batch.size(), is_rejected.get());
+    else
+        _root = _insertBatch(_root, batch.data(), batch.size(), is_rejected.get());
+
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        if (is_rejected[i]) { _freeNode(batch[i]); continue; }
+        _indexInsert(batch[i]);
+        results[positions[i]] = true;
+    }
+    return results;
+}
+
+/**
+ *  @brief  Join two trees and a pivot, created with ID and name, into one tree, moving their @c Nodes without copying
+ *  @param  left  tree whose IDs precede the pivot; emptied
+ *  @param  id  integer ID of the pivot
+ *  @param  name  full name of the pivot
+ *  @param  right  tree whose IDs follow the pivot; emptied
+ *  @return joined tree, with the indexes enabled on either tree; trees whose IDs are not so ordered are
+ *          instead merged as by @c insertBatch
+ *  @complexity O(log n) (worst-case) for ordered trees without indexes; O(n) to rebuild any index
+ */
+AVLTree AVLTree::join(AVLTree&& left, const int id, const string& name, AVLTree&& right)
+{
+    AVLTree tree;
+    Node* left_root = left._root;
+    Node* right_root = right._root;
+    left._root = nullptr;
+    right._root = nullptr;
+    left._dropCursors();
+    right._dropCursors();
+    tree._shareArenas(left);
+    tree._shareArenas(right);
+
+    Node* left_max = _getRightmost(left_root);
+    Node* right_min = _getLeftmost(right_root);
+    if ((!left_max || left_max->id < id) && (!right_min || id < right_min->id))
+    {
+        tree._root = _join(left_root, new Node(id, name), right_root);
+    }
+    else
+    {
+        tree._root = left_root;
+        tree.insert(id, name);
+        vector<Node*> batch;
+        _flatten(right_root, batch);
+        std::unique_ptr<bool[]> is_rejected(new bool[batch.size()]());
+        tree._root = _insertBatch(tree._root, batch.data(), batch.size(), is_rejected.get());
+        for (size_t i = 0; i < batch.size(); i++) if (is_rejected[i]) tree._freeNode(batch[i]);
+    }
+
+    // the indexes enabled on either tree carry over, and those left behind no longer refer to the moved Nodes
+    tree._presence = left._presence ? std::move(left._presence) : std::move(right._presence);
+    tree._hash = left._hash ? std::move(left._hash) : std::move(right._hash);
+    left._rebuildIndexes();
+    right._rebuildIndexes();
+    tree._rebuildIndexes();
+    return tree;
+}
+
+/**
+ *  @brief  Split @c this tree, by ID, into the trees of lesser and of greater IDs, moving its @c Nodes without copying
+ *  @param  id  integer ID
+ *  @param  left  tree that is replaced by the @c Nodes with lesser IDs
+ *  @param  name  string to which the name of the @c Node with the ID is copied, if found
+ *  @param  right  tree that is replaced by the @c Nodes with greater IDs
+ *  @return boolean indicating whether the ID was found; @c this tree is emptied either way
+ *  @complexity O(log n) (worst-case), plus the freeing of any @c Nodes @c left and @c right held
+ */
+bool AVLTree::split(const int id, AVLTree& left, string& name, AVLTree& right)
+{
+    if (&left != this) left.clear(); // the Nodes being replaced are freed, not leaked
+    if (&right != this) right.clear();
+    Node* left_root = nullptr;
+    Node* right_root = nullptr;
+    Node* match = _split(_root, id, left_root, right_root);
+    _root = nullptr;
+    left._root = left_root;
+    right._root = right_root;
+    _dropCursors();
+    left._dropCursors();
+    right._dropCursors();
+    left._shareArenas(*this);
+    right._shareArenas(*this);
+    _rebuildIndexes();
+    left._rebuildIndexes();
+    right._rebuildIndexes();
+
+    if (!match) return false;
+    name = match->name;
+    _freeNode(match);
+    return true;
+}
+
+/**
+ *  @brief  Split off, by ID, the @c Nodes with greater or equal IDs into a new tree, moving them without copying
+ *  @param  id  integer ID
+ *  @return tree of the @c Nodes with greater or equal IDs; those with lesser IDs remain in @c this tree
+ *  @complexity O(log n) (worst-case)
+ */
+AVLTree AVLTree::splitOff(const int id)
+{
+    AVLTree upper;
+    upper._shareArenas(*this);
+    Node* match = _split(_root, id, _root, upper._root);
+    if (match) upper._root = _join(nullptr, match, upper._root);
+    _indexSubtree(upper._root, false);
+    _dropCursors();
+    return upper;
+}
+
+/**
+ *  @brief  Merge another tree into @c this tree, keeping the IDs found in either
+ *  @param  other  tree to be merged; emptied
+ *  @param  policy  @c Conflict policy choosing whose name is kept for an ID found in both trees
+ *  @param  pool  pool onto which recursive halves of large trees are forked; @c nullptr to run sequentially
+ *  @complexity O(m log(n/m + 1)) work, O(log^2 n) span (worst-case)
+ */
+void AVLTree::unionWith(AVLTree&& other, const Conflict policy, ThreadPool* pool)
+{
+    vector<Node*> discards;
+    _shareArenas(other);
+    _indexSubtree(other._root, true);
+    _root = _union(_root, other._root, policy, discards, pool);
+    other._root = nullptr;
+    other._rebuildIndexes(); // clears those of the other tree, which no longer holds the moved Nodes
+    _dropCursors();
+    other._dropCursors();
+    for (Node* node : discards)
+    {
+        if (_hash) _hash->insert(_find(_root, node->id)); // the kept Node sharing the ID
+        _freeNode(node);
+    }
+}
+
+/**
+ *  @brief  Merge another tree into @c this tree, keeping the IDs found in both
+ *  @param  other  tree to be merged; emptied
+ *  @param  policy  @c Conflict policy choosing whose name is kept for an ID found in both trees
+ *  @param  pool  pool onto which recursive halves of large trees are forked; @c nullptr to run sequentially
+ *  @complexity O(m log(n/m + 1)) work, O(log^2 n) span (worst-case)
+ */
+void AVLTree::intersect(AVLTree&& other, const Conflict policy, ThreadPool* pool)
+{
+    vector<Node*> discards;
+    _shareArenas(other);
+    _root = _intersect(_root, other._root, policy, discards, pool);
+    other._root = nullptr;
+    other._rebuildIndexes();
+    _dropCursors();
+    other._dropCursors();
+    for (Node* node : discards) _freeNode(node);
+    _rebuildIndexes();
+}
+
+/**
+ *  @brief  Remove from @c this tree the IDs found in another tree
+ *  @param  other  tree whose IDs are removed; emptied
+ *  @param  pool  pool onto which recursive halves of large trees are forked; @c nullptr to run sequentially
+ *  @complexity O(m log(n/m + 1)) work, O(log^2 n) span (worst-case)
+ */
+void AVLTree::difference(AVLTree&& other, ThreadPool* pool)
+{
+    vector<Node*> discards;
+    _shareArenas(other);
+    _indexSubtree(other._root, false);
+    _root = _difference(_root, other._root, discards, pool);
+    other._root = nullptr;
+    other._rebuildIndexes();
+    _dropCursors();
+    other._dropCursors();
+    for (Node* node : discards) _freeNode(node);
 }
 
 /**
@@ -515,10 +2095,12 @@ bool AVLTree::insert(const int id, const string& name)
  */
 bool AVLTree::remove(const int id)
 {
-    bool is_leaf = (!_root->left && !_root->right);
-    bool is_removed = _remove(_root, nullptr, id);
-    if (is_leaf && is_removed) { _root = nullptr; }
-    return is_removed;
+    Node* removal = nullptr;
+    _storeLink(_root, _remove(_root, id, removal));
+    if (!removal) return false;
+    _deleteNode(removal);
+    _dropCursors();
+    return true;
 }
 
 /**
@@ -528,10 +2110,142 @@ bool AVLTree::remove(const int id)
  */
 bool AVLTree::removeInorder(int count)
 {
-    bool is_leaf = (!_root->left && !_root->right);
-    bool is_removed = _removeInorder(_root, nullptr, &count);
-    if (is_leaf && is_removed) { _root = nullptr; }
-    return is_removed;
+    Node* removal = nullptr;
+    _storeLink(_root, _removeInorder(_root, &count, removal));
+    if (!removal) return false;
+    _deleteNode(removal);
+    _dropCursors();
+    return true;
+}
+
+/**
+ *  @brief  Remove from @c this tree every @c Node with an ID in a range, splitting the range out and
+ *          concatenating what remains around it
+ *  @param  low  least integer ID of the range
+ *  @param  high  greatest integer ID of the range
+ *  @return number of removed nodes
+ *  @complexity O(log n + k) (worst-case)
+ */
+size_t AVLTree::removeRange(const int low, const int high)
+{
+    if (!_root || low > high) return 0;
+
+    Node* left = nullptr;
+    Node* rest = nullptr;
+    Node* middle = nullptr;
+    Node* right = nullptr;
+    Node* low_match = _split(_root, low, left, rest);
+    Node* high_match = _split(rest, high, middle, right);
+    _root = _concatenate(left, right);
+    _dropCursors();
+
+    size_t count = _deleteSubtree(middle);
+    if (low_match) { _deleteNode(low_match); count++; }
+    if (high_match) { _deleteNode(high_match); count++; }
+    return count;
+}
+
+/**
+ *  @brief  Remove from @c this tree the @c Nodes with IDs in a list, merging the list with the tree in one pass
+ *  @param  ids  list of integer IDs, preferably sorted; an unsorted list is sorted first
+ *  @return number of removed nodes
+ *  @complexity O(k log(n/k + 1)) (worst-case) for a sorted list
+ */
+size_t AVLTree::removeBatch(const vector<int>& ids)
+{
+    vector<int> sorted_ids;
+    const vector<int>* batch = &ids;
+    if (!std::is_sorted(ids.begin(), ids.end()))
+    {
+        sorted_ids = ids;
+        std::sort(sorted_ids.begin(), sorted_ids.end());
+        batch = &sorted_ids;
+    }
+
+    vector<Node*> removals;
+    _root = _removeBatch(_root, batch->data(), batch->size(), removals);
+    _dropCursors();
+    for (Node* node : removals) _deleteNode(node);
+    return removals.size();
+}
+
+/**
+ *  @brief  Remove from @c this tree the @c Nodes between two inorder counts
+ *  @param  first  inorder count of the first @c Node removed
+ *  @param  last  inorder count of the last @c Node removed; clamped to the last @c Node of @c this tree
+ *  @return number of removed nodes
+ *  @complexity O(n) (worst-case), to count the @c Nodes; O(log n + k) (worst-case) to remove them
+ */
+size_t AVLTree::removeInorderRange(int first, int last)
+{
+    if (first < 0 || last < first) return 0;
+
+    Node* low = _selectInorder(_root, first);
+    if (!low) return 0;
+    Node* high = _selectInorder(_root, last);
+    return removeRange(low->id, high ? high->id : _getRightmost(_root)->id);
+}
+
+/**
+ *  @brief  Get the least ID of @c this tree, from the cached left spine
+ *  @return least integer ID; -1 if @c this tree is empty
+ *  @complexity O(1) (worst-case) while the spine is cached; O(log n) (worst-case) otherwise
+ */
+int AVLTree::min()
+{
+    _buildSpine(_leftSpine, true);
+    return _leftSpine.empty() ? -1 : _leftSpine.back()->id;
+}
+
+/**
+ *  @brief  Get the greatest ID of @c this tree, from the cached right spine
+ *  @return greatest integer ID; -1 if @c this tree is empty
+ *  @complexity O(1) (worst-case) while the spine is cached; O(log n) (worst-case) otherwise
+ */
+int AVLTree::max()
+{
+    _buildSpine(_rightSpine, false);
+    return _rightSpine.empty() ? -1 : _rightSpine.back()->id;
+}
+
+/**
+ *  @brief  Remove the @c Node with the least ID from @c this tree, as from the front of an ordered queue
+ *  @param  id  pointer to which the ID is copied, if not @c nullptr
+ *  @param  name  pointer to which the name is copied, if not @c nullptr
+ *  @return boolean indicating whether a node was removed; @c false if @c this tree is empty
+ *  @complexity O(1) (amortized) over a sequence of pops; O(log n) (worst-case)
+ */
+bool AVLTree::popMin(int* id, string* name)
+{
+    _buildSpine(_leftSpine, true);
+    if (_leftSpine.empty()) return false;
+
+    _finger.clear();
+    Node* removal = _popSpine(_leftSpine, true);
+    if (id) *id = removal->id;
+    if (name) *name = std::move(removal->name);
+    _deleteNode(removal);
+    return true;
+}
+
+/**
+ *  @brief  Remove the @c Node with the greatest ID from @c this tree, as from the back of an ordered queue
+ *  @param  id  pointer to which the ID is copied, if not @c nullptr
+ *  @param  name  pointer to which the name is copied, if not @c nullptr
+ *  @return boolean indicating whether a node was removed; @c false if @c this tree is empty
+ *  @complexity O(1) (amortized) over a sequence of pops; O(log n) (worst-case)
+ */
+bool AVLTree::popMax(int* id, string* name)
+{
+    _buildSpine(_rightSpine, false);
+    if (_rightSpine.empty()) return false;
+
+    _finger.clear();
+    Node* removal = _popSpine(_rightSpine, false);
+    if (id) *id = removal->id;
+    if (name) *name = std::move(removal->name);
+    _deleteNode(removal);
+    return true;
 }
 
 /**
@@ -541,11 +2255,52 @@ bool AVLTree::removeInorder(int count)
  */
 string AVLTree::search(const int id)
 {
+    if (_hash)
+    {
+        Node* node = _hash->find(id);
+        return node ? node->name : "";
+    }
+    if (_presence && PresenceBitmap::inDomain(id) && !_presence->test(id)) return ""; // miss without descending
+
     string match;
     _search(_root, id, match);
     return match;
 }
 
+/**
+ *  @brief  Find, by descent from the root, the @c Node with an ID, without consulting the indexes
+ *  @param  id integer ID
+ *  @return pointer to the @c Node; @c nullptr if not found
+ *  @complexity O(log n) (worst-case)
+ */
+const Node* AVLTree::find(const int id) const
+{
+    return _find(_loadLink(_root), id);
+}
+
+/**
+ *  @brief  Search for an ID from the @c Nodes of @c this tree, starting from the finger left by the previous
+ *          @c searchNear or @c insertHint, for scans with strong locality
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found. The finger rests on the last @c Node visited
+ *  @complexity O(log d) (worst-case), for the number d of IDs between the finger and the ID
+ */
+string AVLTree::searchNear(const int id)
+{
+    if (!_root) return "";
+    if (_finger.empty() || _finger[0].node != _root) _seekFinger(id);
+
+    while (_finger.size() > 1)
+    {
+        const FingerStep& step = _finger.back();
+        if ((!step.lower || step.lower->id < id) && (!step.upper || id < step.upper->id)) break;
+        _finger.pop_back();
+    }
+    _extendFinger(id);
+    Node* node = _finger.back().node;
+    return (node->id == id) ? node->name : "";
+}
+
 /**
  *  @brief  Search for a name from the @c Nodes of @c this tree
  *  @param  root  pointer to the root @c Node of the tree
@@ -559,4 +2314,227 @@ vector<string> AVLTree::search(const string& name)
     return matches;
 }
 
+/**
+ *  @brief  Search for a name from the @c Nodes of @c this tree, scanning large subtrees in parallel
+ *  @param  name  full name
+ *  @param  pool  pool onto which subtrees are forked
+ *  @return list of IDs of the @c Nodes with the name, in the same order as @c search(name)
+ */
+vector<string> AVLTree::search(const string& name, ThreadPool& pool)
+{
+    vector<string> matches;
+    _searchParallel(_root, name, matches, pool);
+    return matches;
+}
+
+/**
+ *  @brief  Copy the IDs and names of @c this tree in ID order
+ *  @return list of pairs of integer ID and full name, as taken by @c buildFromSorted
+ *  @complexity O(n) (worst-case)
+ */
+vector<pair<int, string>> AVLTree::sortedEntries()
+{
+    vector<Node*> nodes;
+    _flatten(_root, nodes);
+
+    vector<pair<int, string>> entries;
+    entries.reserve(nodes.size());
+    for (Node* node : nodes) entries.emplace_back(node->id, node->name);
+    return entries;
+}
+
+/**
+ *  @brief  Create an immutable snapshot of @c this tree laid out for branchless search
+ *  @return snapshot of the IDs and names of @c this tree
+ *  @complexity O(n) (worst-case)
+ */
+FrozenAVLTree AVLTree::freeze()
+{
+    vector<Node*> nodes;
+    _flatten(_root, nodes);
+
+    vector<int> ids;
+    vector<string> names;
+    ids.reserve(nodes.size());
+    names.reserve(nodes.size());
+    for (Node* node : nodes)
+    {
+        ids.push_back(node->id);
+        names.push_back(node->name);
+    }
+    return FrozenAVLTree(ids, std::move(names));
+}
+
+/**
+ *  @brief  Measure how closely the @c Nodes of @c this tree are laid out in memory
+ *  @return mean distance in bytes between parent and child, ratio of parent-child links crossing
+ *          a 4 KiB page, and number of distinct 4 KiB pages holding @c Nodes
+ *  @complexity O(n log n) (worst-case)
+ */
+AVLTree::LayoutStats AVLTree::layoutStats()
+{
+    const uintptr_t page_size = 4096;
+    vector<Node*> nodes;
+    _flatten(_root, nodes);
+
+    double distance_sum = 0;
+    size_t links = 0, page_crossings = 0;
+    vector<uintptr_t> pages;
+    pages.reserve(nodes.size());
+    for (Node* node : nodes)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(node);
+        pages.push_back(address / page_size);
+        for (Node* child : {node->left, node->right})
+        {
+            if (!child) continue;
+            const uintptr_t child_address = reinterpret_cast<uintptr_t>(child);
+            distance_sum += static_cast<double>(std::max(address, child_address) - std::min(address, child_address));
+            page_crossings += (address / page_size != child_address / page_size);
+            links++;
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+
+    LayoutStats stats{};
+    stats.mean_edge_bytes = links ? distance_sum / static_cast<double>(links) : 0;
+    stats.page_crossing_ratio = links ? static_cast<double>(page_crossings) / static_cast<double>(links) : 0;
+    stats.page_span = static_cast<size_t>(std::unique(pages.begin(), pages.end()) - pages.begin());
+    return stats;
+}
+
+/**
+ *  @brief  Relocate the @c Nodes of @c this tree into one contiguous arena in van Emde Boas order
+ *  @note   @c this tree stays mutable; @c Nodes inserted afterwards are allocated individually
+ *  @complexity O(n log log n) (worst-case)
+ */
+void AVLTree::compact()
+{
+    if (!_root) return;
+
+    vector<Node*> order;
+    _orderVanEmdeBoas(_root, _root->height + 1, order);
+    shared_ptr<NodeArena> arena = make_shared<NodeArena>(order.size());
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        Node* node = order[i];
+        Node* slot = new (arena->nodes + i) Node(node->id, std::move(node->name));
+        slot->height = node->height;
+        node->height = static_cast<int>(i); // the old Node records the index of its slot until it is deleted
+    }
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        Node* node = order[i];
+        Node* slot = arena->nodes + i;
+        slot->left = node->left ? arena->nodes + node->left->height : nullptr;
+        slot->right = node->right ? arena->nodes + node->right->height : nullptr;
+    }
+
+    _root = arena->nodes + _root->height;
+    for (Node* node : order) _freeNode(node);
+    if (_retiredCount) _retiredArenas.insert(_retiredArenas.end(), _arenas.begin(), _arenas.end());
+    _arenas.assign(1, arena);
+    _rebuildIndexes();
+    _dropCursors();
+}
+
+/**
+ *  @brief  Collect the @c Nodes that @c this tree unlinks in a list instead of freeing them, so that readers
+ *          still holding them, such as the optimistic readers of @c ConcurrentAVLTree, never see freed memory
+ *  @param  retired  list to which unlinked @c Nodes are added; @c nullptr to free them at once again
+ *  @note   arenas that @c compact, @c clear or a move drop are kept until every retired @c Node has been released
+ */
+void AVLTree::deferFrees(vector<Node*>* retired)
+{
+    _retired = retired;
+}
+
+/**
+ *  @brief  Free the @c Nodes collected while frees were deferred, once no reader can hold them
+ *  @param  retired  list of unlinked @c Nodes of @c this tree; emptied
+ */
+void AVLTree::releaseDeferred(vector<Node*>& retired)
+{
+    for (Node* node : retired) _releaseNode(node);
+    _retiredCount -= std::min(_retiredCount, retired.size());
+    if (!_retiredCount) _retiredArenas.clear();
+    retired.clear();
+}
+
+/**
+ *  @brief  Enable a presence bitmap over the 8-digit ID domain, which answers failed searches and
+ *          duplicate insertions without descending @c this tree and counts IDs by rank
+ *  @note   the bitmap takes 12.5 MB and is kept in sync by every mutation; bulk operations update it
+ *          in time proportional to the @c Nodes they move, except @c intersect and @c split, which rebuild it
+ *  @complexity O(n) (worst-case)
+ */
+void AVLTree::enablePresenceBitmap()
+{
+    _presence = make_shared<PresenceBitmap>();
+    _rebuildIndexes();
+}
+
+/**
+ *  @brief  Enable a hash index from ID to @c Node, which answers searches by ID and duplicate insertions
+ *          in expected constant time; ordered operations keep using @c this tree
+ *  @note   the index is kept in sync by every mutation and takes 32 to 64 bytes per ID
+ *  @complexity O(n) (expected)
+ */
+void AVLTree::enableHashIndex()
+{
+    _hash = make_shared<HashIndex>();
+    _rebuildIndexes();
+}
+
+/**
+ *  @brief  Get the memory held by the hash index of @c this tree
+ *  @return number of bytes; 0 if the index is not enabled
+ */
+size_t AVLTree::hashIndexBytes()
+{
+    return _hash ? _hash->memoryBytes() : 0;
+}
+
+/**
+ *  @brief  Count the IDs of @c this tree less than an ID
+ *  @param  id  integer ID
+ *  @return number of lesser IDs; with the presence bitmap enabled, only IDs in the 8-digit domain are counted
+ *  @complexity O(log n) with the presence bitmap enabled, O(n) otherwise (worst-case)
+ */
+size_t AVLTree::rank(const int id)
+{
+    if (_presence && PresenceBitmap::inDomain(id)) return _presence->rank(id);
+
+    vector<Node*> nodes;
+    _flatten(_root, nodes);
+    return lower_bound(nodes.begin(), nodes.end(), id,
+                       [](const Node* node, const int key) { return node->id < key; }) - nodes.begin();
+}
+
+/**
+ *  @brief  Identify, by inorder count, an ID of @c this tree
+ *  @param  count  inorder count
+ *  @return integer ID; -1 if the count is out of bounds
+ *  @complexity O(n) (worst-case)
+ */
+int AVLTree::selectInorder(int count)
+{
+    const Node* match = _selectInorder(_root, count);
+    return match ? match->id : -1;
+}
+
+/**
+ *  @brief  Search for a batch of IDs from the @c Nodes of @c this tree
+ *  @param  ids  list of integer IDs
+ *  @return list of names corresponding to the IDs, in the same order; empty where an ID is not found
+ *  @complexity O(k log n) (worst-case)
+ */
+vector<string> AVLTree::searchBatch(const vector<int>& ids)
+{
+    vector<string> matches(ids.size());
+    _searchBatch(_root, ids.data(), ids.size(), matches.data());
+    return matches;
+}
+
 #endif //AVLTREE_H
\ No newline at end of file
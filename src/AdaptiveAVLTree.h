@@ -0,0 +1,317 @@
+#ifndef ADAPTIVEAVLTREE_H
+#define ADAPTIVEAVLTREE_H
+
+#include "AVLTree.h"
+#include <string>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+using std::string;
+using std::vector;
+using std::queue;
+using std::pair;
+using std::to_string;
+
+/// Object class for a set of IDs and names kept in a sorted array while small and in an @c AVLTree once large.
+/// The array keeps no insertion history, so the outputs that depend on shape (preorder, postorder, levelorder,
+/// name search and level count) follow the perfectly balanced tree of its entries, and once promoted the tree
+/// grown from that one, not the @c AVLTree that the same commands would have grown; only inorder output, ID
+/// search and size match an @c AVLTree throughout
+class AdaptiveAVLTree {
+
+private:
+    vector<pair<int, string>> _entries; // sorted by ID; holds every entry while flat, none otherwise
+    AVLTree _tree; // holds every entry once promoted, none otherwise
+    size_t _size = 0;
+    size_t _threshold;
+    bool _isFlat = true;
+    void _promote();
+    void _demote();
+    vector<pair<int, string>>::iterator _lowerBound(int id);
+    void _copyPreorder(size_t first, size_t count, string& names) const;
+    void _copyPostorder(size_t first, size_t count, string& names) const;
+    void _copyLevelorder(string& names) const;
+    void _search(size_t first, size_t count, const string& name, vector<string>& matches) const;
+
+public:
+    static const size_t DEFAULT_THRESHOLD = 32;
+    explicit AdaptiveAVLTree(size_t threshold = DEFAULT_THRESHOLD);
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    bool removeInorder(int count);
+    string search(int id);
+    vector<string> search(const string& name);
+    string traversalToString(AVLTree::Traversal type);
+    int levelCount();
+    size_t size() const;
+    bool isFlat() const;
+};
+
+/**
+ *  @brief  Create an empty set, flat until it holds more entries than a threshold
+ *  @param  threshold  largest number of entries held in the sorted array; a tree is demoted back to the array
+ *          below half of it, so that sizes hovering about the threshold do not convert on every operation
+ */
+AdaptiveAVLTree::AdaptiveAVLTree(const size_t threshold) : _threshold(threshold) {}
+
+/**
+ *  @brief  Move the entries of the sorted array into a perfectly balanced tree
+ *  @complexity O(n) (worst-case)
+ */
+void AdaptiveAVLTree::_promote()
+{
+    _tree = AVLTree::buildFromSorted(_entries.begin(), _entries.end());
+    vector<pair<int, string>>().swap(_entries);
+    _isFlat = false;
+}
+
+/**
+ *  @brief  Move the entries of the tree into the sorted array
+ *  @complexity O(n) (worst-case)
+ */
+void AdaptiveAVLTree::_demote()
+{
+    _entries = _tree.sortedEntries();
+    _tree.clear();
+    _isFlat = true;
+}
+
+/**
+ *  @brief  Find, in the sorted array, the first entry whose ID is not less than an ID
+ *  @param  id  integer ID
+ *  @return iterator to the entry; end of the array if there is none
+ *  @complexity O(log n) (worst-case)
+ */
+vector<pair<int, string>>::iterator AdaptiveAVLTree::_lowerBound(const int id)
+{
+    return std::lower_bound(_entries.begin(), _entries.end(), id,
+                            [](const pair<int, string>& entry, const int key) { return entry.first < key; });
+}
+
+/**
+ *  @brief Copies a comma-separated preorder traversal of the balanced tree implied by a range of the array
+ *  @param first  position of the first entry of the range
+ *  @param count  number of entries in the range
+ *  @param names  string to which names list is copied
+ */
+void AdaptiveAVLTree::_copyPreorder(const size_t first, const size_t count, string& names) const
+{
+    if (!count) return;
+
+    const size_t middle = count / 2; // the root chosen by AVLTree::buildFromSorted
+    names += (_entries[first + middle].second + ", ");
+    _copyPreorder(first, middle, names);
+    _copyPreorder(first + middle + 1, count - middle - 1, names);
+}
+
+/**
+ *  @brief Copies a comma-separated postorder traversal of the balanced tree implied by a range of the array
+ *  @param first  position of the first entry of the range
+ *  @param count  number of entries in the range
+ *  @param names  string to which names list is copied
+ */
+void AdaptiveAVLTree::_copyPostorder(const size_t first, const size_t count, string& names) const
+{
+    if (!count) return;
+
+    const size_t middle = count / 2;
+    _copyPostorder(first, middle, names);
+    _copyPostorder(first + middle + 1, count - middle - 1, names);
+    names += (_entries[first + middle].second + ", ");
+}
+
+/**
+ *  @brief Copies a comma-separated levelorder traversal of the balanced tree implied by the array
+ *  @param names  string to which names list is copied
+ */
+void AdaptiveAVLTree::_copyLevelorder(string& names) const
+{
+    queue<pair<size_t, size_t>> ranges_queue; // first position and count of each subtree
+    ranges_queue.push({0, _entries.size()});
+    while (!ranges_queue.empty())
+    {
+        const pair<size_t, size_t> range = ranges_queue.front();
+        ranges_queue.pop();
+        if (!range.second) continue;
+
+        const size_t middle = range.second / 2;
+        names += (_entries[range.first + middle].second + ", ");
+        ranges_queue.push({range.first, middle});
+        ranges_queue.push({range.first + middle + 1, range.second - middle - 1});
+    }
+}
+
+/**
+ *  @brief Search, by name, and copy a list of IDs from the balanced tree implied by a range of the array
+ *  @param first  position of the first entry of the range
+ *  @param count  number of entries in the range
+ *  @param name  full name
+ *  @param matches vector to which list of IDs is to be copied, in preorder
+ */
+void AdaptiveAVLTree::_search(const size_t first, const size_t count, const string& name,
+                              vector<string>& matches) const
+{
+    if (!count) return;
+
+    const size_t middle = count / 2;
+    if (_entries[first + middle].second == name) matches.push_back(AVLTree::idToString(_entries[first + middle].first));
+    _search(first, middle, name, matches);
+    _search(first + middle + 1, count - middle - 1, name, matches);
+}
+
+/**
+ *  @brief  Insert an ID and name to @c this set, promoting it to a tree past the threshold
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the ID was inserted successfully
+ *  @complexity O(n) (worst-case) while flat; O(log n) (worst-case) otherwise
+ */
+bool AdaptiveAVLTree::insert(const int id, const string& name)
+{
+    if (!_isFlat)
+    {
+        if (!_tree.insert(id, name)) return false;
+        _size++;
+        return true;
+    }
+
+    const auto position = _lowerBound(id);
+    if (position != _entries.end() && position->first == id) return false;
+    _entries.emplace(position, id, name);
+    if (++_size > _threshold) _promote();
+    return true;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove an entry from @c this set, demoting it to the array below half the threshold
+ *  @param  id integer ID
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(n) (worst-case) while flat; O(log n) (amortized) otherwise
+ */
+bool AdaptiveAVLTree::remove(const int id)
+{
+    if (!_isFlat)
+    {
+        if (!_tree.remove(id)) return false;
+        if (--_size < _threshold / 2) _demote();
+        return true;
+    }
+
+    const auto position = _lowerBound(id);
+    if (position == _entries.end() || position->first != id) return false;
+    _entries.erase(position);
+    _size--;
+    return true;
+}
+
+/**
+ *  @brief  Identify, by inorder count, and remove an entry from @c this set
+ *  @param  count inorder count
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(n) (worst-case)
+ */
+bool AdaptiveAVLTree::removeInorder(const int count)
+{
+    if (!_isFlat)
+    {
+        if (!_tree.removeInorder(count)) return false;
+        if (--_size < _threshold / 2) _demote();
+        return true;
+    }
+
+    if (count < 0 || static_cast<size_t>(count) >= _entries.size()) return false;
+    _entries.erase(_entries.begin() + count);
+    _size--;
+    return true;
+}
+
+/**
+ *  @brief  Search for an ID from @c this set
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @complexity O(log n) (worst-case)
+ */
+string AdaptiveAVLTree::search(const int id)
+{
+    if (!_isFlat) return _tree.search(id);
+
+    const auto position = _lowerBound(id);
+    return (position != _entries.end() && position->first == id) ? position->second : "";
+}
+
+/**
+ *  @brief  Search for a name from @c this set
+ *  @param  name  full name
+ *  @return list of 8-character IDs with the name, in preorder
+ *  @complexity O(n) (worst-case)
+ */
+vector<string> AdaptiveAVLTree::search(const string& name)
+{
+    if (!_isFlat) return _tree.search(name);
+
+    vector<string> matches;
+    _search(0, _entries.size(), name, matches);
+    return matches;
+}
+
+/**
+ *  @brief  Get a comma-separated list of names from @c this set
+ *  @param  type type of tree traversal to generate the list from
+ *  @return comma-separated list of names as a string; while flat, the traversal is of the tree that a promotion
+ *          would build, which is also the one @c AVLTree::buildFromSorted builds from the same entries
+ *  @complexity O(n) (worst-case)
+ */
+string AdaptiveAVLTree::traversalToString(const AVLTree::Traversal type)
+{
+    if (!_isFlat) return _tree.traversalToString(type);
+    if (_entries.empty()) return "";
+    string names;
+
+    switch (type)
+    {
+        case AVLTree::INORDER: for (const pair<int, string>& entry : _entries) names += (entry.second + ", "); break;
+        case AVLTree::PREORDER: _copyPreorder(0, _entries.size(), names); break;
+        case AVLTree::POSTORDER: _copyPostorder(0, _entries.size(), names); break;
+        case AVLTree::LEVELORDER: _copyLevelorder(names); break;
+        default: return "";
+    }
+
+    names.pop_back(); // removes the last space
+    names.pop_back(); // removes the last comma
+    return names;
+}
+
+/**
+ *  @brief  Get the number of levels from root to most distant leaf of @c this set, as a tree
+ *  @return highest level of @c this set
+ *  @complexity O(log n) (worst-case) while flat; O(n) (worst-case) otherwise
+ */
+int AdaptiveAVLTree::levelCount()
+{
+    if (!_isFlat) return _tree.levelCount();
+
+    int level_count = 0;
+    for (size_t count = _entries.size(); count; count /= 2) level_count++; // the larger half holds count / 2
+    return level_count;
+}
+
+/**
+ *  @brief  Get the number of IDs in @c this set
+ *  @return number of IDs
+ */
+size_t AdaptiveAVLTree::size() const
+{
+    return _size;
+}
+
+/**
+ *  @brief  Check whether @c this set is held in the sorted array
+ *  @return boolean indicating whether @c this set is flat
+ */
+bool AdaptiveAVLTree::isFlat() const
+{
+    return _isFlat;
+}
+
+#endif //ADAPTIVEAVLTREE_H
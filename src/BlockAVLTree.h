@@ -0,0 +1,828 @@
+#ifndef BLOCKAVLTREE_H
+#define BLOCKAVLTREE_H
+
+#include "AVLTree.h"
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using std::string;
+using std::vector;
+using std::queue;
+using std::to_string;
+using std::max;
+
+/// Object class for a node of a block tree, holding a sorted block of student IDs and handles to their names
+class KeyBlock {
+
+public:
+    static const int CAPACITY = 32;
+    alignas(16) int ids[CAPACITY]; // sorted; unused slots hold INT_MAX so that whole vectors compare safely
+    uint32_t names[CAPACITY]; // handles into the name pool of the tree, aligned with the IDs
+    KeyBlock* left;
+    KeyBlock* right;
+    int height;
+    int count;
+
+    KeyBlock() : left(nullptr), right(nullptr), height(0), count(0) { std::fill(ids, ids + CAPACITY, INT_MAX); }
+    int lowerBound(int id) const;
+};
+
+/**
+ *  @brief  Find the position of the least ID of @c this block not less than an ID, four compares at a time
+ *  @param  id  integer ID
+ *  @return position of the least ID not less than the ID; @c count if there is none
+ *  @complexity O(B) (worst-case), in B / 4 vector compares
+ */
+int KeyBlock::lowerBound(const int id) const
+{
+#ifdef __SSE2__
+    const __m128i key = _mm_set1_epi32(id);
+    __m128i less = _mm_setzero_si128();
+    for (int i = 0; i < count; i += 4)
+    {
+        const __m128i values = _mm_load_si128(reinterpret_cast<const __m128i*>(ids + i));
+        less = _mm_sub_epi32(less, _mm_cmplt_epi32(values, key)); // each lane counts its IDs less than the key
+    }
+    less = _mm_add_epi32(less, _mm_shuffle_epi32(less, _MM_SHUFFLE(1, 0, 3, 2)));
+    less = _mm_add_epi32(less, _mm_shuffle_epi32(less, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(less);
+#else
+    return static_cast<int>(std::lower_bound(ids, ids + count, id) - ids);
+#endif
+}
+
+/// Object class for a self-balancing tree whose nodes each hold a sorted block of up to @c KeyBlock::CAPACITY IDs
+class BlockAVLTree {
+
+private:
+    KeyBlock* _root = nullptr;
+    vector<string> _names; // name pool indexed by the handles of the blocks
+    vector<uint32_t> _freeNames; // handles of released names, reused before the pool grows
+    size_t _size = 0;
+    size_t _blockCount = 0;
+    static const int MIN_FILL = KeyBlock::CAPACITY / 4;
+    static KeyBlock* _rotateLeft(KeyBlock* root);
+    static KeyBlock* _rotateRight(KeyBlock* root);
+    static int _getHeight(KeyBlock* root);
+    static void _updateHeight(KeyBlock* root);
+    static int _getBalance(KeyBlock* root);
+    static KeyBlock* _updateBalance(KeyBlock* root);
+    static KeyBlock* _getLeftmost(KeyBlock* root);
+    static KeyBlock* _getRightmost(KeyBlock* root);
+    static KeyBlock* _attachLeftmost(KeyBlock* root, KeyBlock* block);
+    static KeyBlock* _detachLeftmost(KeyBlock* root, KeyBlock*& leftmost);
+    static KeyBlock* _detachRightmost(KeyBlock* root, KeyBlock*& rightmost);
+    static KeyBlock* _unlink(KeyBlock* root);
+    static void _insertAt(KeyBlock* block, int position, int id, uint32_t name);
+    static void _eraseAt(KeyBlock* block, int position);
+    static void _moveTail(KeyBlock* low, KeyBlock* high, int count);
+    static void _moveHead(KeyBlock* low, KeyBlock* high, int count);
+    static bool _rebalancePair(KeyBlock* low, KeyBlock* high, bool is_low_kept);
+    static bool _selectInorder(KeyBlock* root, int& count, int& id);
+    uint32_t _storeName(const string& name);
+    void _releaseName(uint32_t handle);
+    void _freeBlock(KeyBlock* block);
+    void _destroy(KeyBlock* root);
+    KeyBlock* _insert(KeyBlock* root, int id, const string& name, bool& is_inserted);
+    KeyBlock* _remove(KeyBlock* root, int id, bool& is_removed);
+    void _copyBlock(const KeyBlock* block, string& names) const;
+    void _copyInorder(KeyBlock* root, string& names) const;
+    void _copyPreorder(KeyBlock* root, string& names) const;
+    void _copyPostorder(KeyBlock* root, string& names) const;
+    void _copyLevelorder(KeyBlock* root, string& names) const;
+    void _search(KeyBlock* root, const string& name, vector<string>& matches) const;
+
+public:
+    enum Traversal { INORDER, PREORDER, POSTORDER, LEVELORDER };
+    BlockAVLTree() = default;
+    ~BlockAVLTree();
+    BlockAVLTree(const BlockAVLTree&) = delete;
+    BlockAVLTree& operator=(const BlockAVLTree&) = delete;
+    BlockAVLTree(BlockAVLTree&& other) noexcept;
+    BlockAVLTree& operator=(BlockAVLTree&& other) noexcept;
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    bool removeInorder(int count);
+    string search(int id) const;
+    vector<string> search(const string& name) const;
+    string traversalToString(Traversal type) const;
+    int levelCount() const;
+    size_t size() const;
+    size_t memoryBytes() const;
+};
+
+/**
+ *  @brief  Rotate a left-left tree branch clockwise
+ *  @param  root pointer to the root @c KeyBlock of the tree branch
+ *  @return pointer to the root @c KeyBlock of the rotated tree branch
+ */
+KeyBlock* BlockAVLTree::_rotateRight(KeyBlock* root)
+{
+    KeyBlock* pivot = root->left;
+    root->left = pivot->right;
+    pivot->right = root;
+    _updateHeight(root);
+    _updateHeight(pivot);
+    return pivot;
+}
+
+/**
+ *  @brief  Rotate a right-right tree branch counterclockwise
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return pointer to the root @c KeyBlock of the rotated tree branch
+ */
+KeyBlock* BlockAVLTree::_rotateLeft(KeyBlock* root)
+{
+    KeyBlock* pivot = root->right;
+    root->right = pivot->left;
+    pivot->left = root;
+    _updateHeight(root);
+    _updateHeight(pivot);
+    return pivot;
+}
+
+/**
+ *  @brief  Get the height of a tree branch
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return height of the tree branch; -1 if empty
+ */
+int BlockAVLTree::_getHeight(KeyBlock* root)
+{
+    return root ? root->height : -1;
+}
+
+/**
+ *  @brief  Recompute the cached height of a @c KeyBlock from those of its children
+ *  @param  root  pointer to the @c KeyBlock
+ */
+void BlockAVLTree::_updateHeight(KeyBlock* root)
+{
+    root->height = 1 + max(_getHeight(root->left), _getHeight(root->right));
+}
+
+/**
+ *  @brief  Get the balance factor of a tree branch
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return difference between the heights of the left and right subtrees
+ */
+int BlockAVLTree::_getBalance(KeyBlock* root)
+{
+    return _getHeight(root->left) - _getHeight(root->right);
+}
+
+/**
+ *  @brief  Update the height of, and rotate if unbalanced, a tree branch
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return pointer to the root @c KeyBlock of the balanced tree branch
+ */
+KeyBlock* BlockAVLTree::_updateBalance(KeyBlock* root)
+{
+    if (!root) return nullptr;
+
+    _updateHeight(root);
+    const int balance = _getBalance(root);
+    if (balance > 1)
+    {
+        if (_getBalance(root->left) < 0) root->left = _rotateLeft(root->left);
+        return _rotateRight(root);
+    }
+    if (balance < -1)
+    {
+        if (_getBalance(root->right) > 0) root->right = _rotateRight(root->right);
+        return _rotateLeft(root);
+    }
+    return root;
+}
+
+/**
+ *  @brief  Get the leftmost @c KeyBlock of a tree branch
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return pointer to the leftmost @c KeyBlock
+ */
+KeyBlock* BlockAVLTree::_getLeftmost(KeyBlock* root)
+{
+    while (root->left) root = root->left;
+    return root;
+}
+
+/**
+ *  @brief  Get the rightmost @c KeyBlock of a tree branch
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return pointer to the rightmost @c KeyBlock
+ */
+KeyBlock* BlockAVLTree::_getRightmost(KeyBlock* root)
+{
+    while (root->right) root = root->right;
+    return root;
+}
+
+/**
+ *  @brief  Link a childless @c KeyBlock as the leftmost of a tree branch, rebalancing along the left spine
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @param  block  pointer to the @c KeyBlock, whose IDs all precede those of the tree branch
+ *  @return pointer to the root @c KeyBlock of the updated tree branch
+ *  @complexity O(log n) (worst-case)
+ */
+KeyBlock* BlockAVLTree::_attachLeftmost(KeyBlock* root, KeyBlock* block)
+{
+    if (!root) return block;
+
+    root->left = _attachLeftmost(root->left, block);
+    return _updateBalance(root);
+}
+
+/**
+ *  @brief  Unlink the leftmost @c KeyBlock of a tree branch, rebalancing along the left spine
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @param  leftmost  pointer to which the unlinked @c KeyBlock is copied
+ *  @return pointer to the root @c KeyBlock of the updated tree branch
+ *  @complexity O(log n) (worst-case)
+ */
+KeyBlock* BlockAVLTree::_detachLeftmost(KeyBlock* root, KeyBlock*& leftmost)
+{
+    if (!root->left)
+    {
+        leftmost = root;
+        return root->right;
+    }
+    root->left = _detachLeftmost(root->left, leftmost);
+    return _updateBalance(root);
+}
+
+/**
+ *  @brief  Unlink the rightmost @c KeyBlock of a tree branch, rebalancing along the right spine
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @param  rightmost  pointer to which the unlinked @c KeyBlock is copied
+ *  @return pointer to the root @c KeyBlock of the updated tree branch
+ *  @complexity O(log n) (worst-case)
+ */
+KeyBlock* BlockAVLTree::_detachRightmost(KeyBlock* root, KeyBlock*& rightmost)
+{
+    if (!root->right)
+    {
+        rightmost = root;
+        return root->left;
+    }
+    root->right = _detachRightmost(root->right, rightmost);
+    return _updateBalance(root);
+}
+
+/**
+ *  @brief  Unlink the root @c KeyBlock of a tree branch, relinking its inorder successor in its place
+ *  @param  root  pointer to the root @c KeyBlock of the tree branch
+ *  @return pointer to the root @c KeyBlock of the remaining tree branch
+ *  @complexity O(log n) (worst-case)
+ */
+KeyBlock* BlockAVLTree::_unlink(KeyBlock* root)
+{
+    if (!root->left) return root->right;
+    if (!root->right) return root->left;
+
+    KeyBlock* successor = nullptr;
+    KeyBlock* right = _detachLeftmost(root->right, successor);
+    successor->left = root->left;
+    successor->right = right;
+    return _updateBalance(successor);
+}
+
+/**
+ *  @brief  Insert an entry at a position of a block that is not full
+ *  @param  block  pointer to the @c KeyBlock
+ *  @param  position  position of the entry
+ *  @param  id  integer ID
+ *  @param  name  handle of the full name
+ */
+void BlockAVLTree::_insertAt(KeyBlock* block, const int position, const int id, const uint32_t name)
+{
+    std::copy_backward(block->ids + position, block->ids + block->count, block->ids + block->count + 1);
+    std::copy_backward(block->names + position, block->names + block->count, block->names + block->count + 1);
+    block->ids[position] = id;
+    block->names[position] = name;
+    block->count++;
+}
+
+/**
+ *  @brief  Erase the entry at a position of a block
+ *  @param  block  pointer to the @c KeyBlock
+ *  @param  position  position of the entry
+ */
+void BlockAVLTree::_eraseAt(KeyBlock* block, const int position)
+{
+    std::copy(block->ids + position + 1, block->ids + block->count, block->ids + position);
+    std::copy(block->names + position + 1, block->names + block->count, block->names + position);
+    block->ids[--block->count] = INT_MAX;
+}
+
+/**
+ *  @brief  Move the last entries of a block to the front of the block that follows it in ID order
+ *  @param  low  pointer to the preceding @c KeyBlock
+ *  @param  high  pointer to the following @c KeyBlock, with room for the entries
+ *  @param  count  number of entries
+ */
+void BlockAVLTree::_moveTail(KeyBlock* low, KeyBlock* high, const int count)
+{
+    std::copy_backward(high->ids, high->ids + high->count, high->ids + high->count + count);
+    std::copy_backward(high->names, high->names + high->count, high->names + high->count + count);
+    std::copy(low->ids + low->count - count, low->ids + low->count, high->ids);
+    std::copy(low->names + low->count - count, low->names + low->count, high->names);
+    std::fill(low->ids + low->count - count, low->ids + low->count, INT_MAX);
+    low->count -= count;
+    high->count += count;
+}
+
+/**
+ *  @brief  Move the first entries of a block to the back of the block that precedes it in ID order
+ *  @param  low  pointer to the preceding @c KeyBlock, with room for the entries
+ *  @param  high  pointer to the following @c KeyBlock
+ *  @param  count  number of entries
+ */
+void BlockAVLTree::_moveHead(KeyBlock* low, KeyBlock* high, const int count)
+{
+    std::copy(high->ids, high->ids + count, low->ids + low->count);
+    std::copy(high->names, high->names + count, low->names + low->count);
+    std::copy(high->ids + count, high->ids + high->count, high->ids);
+    std::copy(high->names + count, high->names + high->count, high->names);
+    std::fill(high->ids + high->count - count, high->ids + high->count, INT_MAX);
+    low->count += count;
+    high->count -= count;
+}
+
+/**
+ *  @brief  Merge two blocks adjacent in ID order into one if their entries fit, or else even out their entries
+ *  @param  low  pointer to the preceding @c KeyBlock
+ *  @param  high  pointer to the following @c KeyBlock
+ *  @param  is_low_kept  whether a merge collects the entries in @p low, rather than in @p high
+ *  @return boolean indicating whether the blocks were merged, leaving the other block empty
+ */
+bool BlockAVLTree::_rebalancePair(KeyBlock* low, KeyBlock* high, const bool is_low_kept)
+{
+    if (low->count + high->count <= KeyBlock::CAPACITY)
+    {
+        if (is_low_kept) _moveHead(low, high, high->count);
+        else _moveTail(low, high, low->count);
+        return true;
+    }
+
+    const int target = (low->count + high->count) / 2;
+    if (low->count < target) _moveHead(low, high, target - low->count);
+    else _moveTail(low, high, low->count - target);
+    return false;
+}
+
+/**
+ *  @brief  Identify, by inorder count, an ID of a tree
+ *  @param  root  pointer to the root @c KeyBlock of the tree
+ *  @param  count  inorder count, decreased by the number of IDs passed over
+ *  @param  id  integer to which the identified ID is copied
+ *  @return boolean indicating whether the count lies within the tree
+ *  @complexity O(n / B) (worst-case)
+ */
+bool BlockAVLTree::_selectInorder(KeyBlock* root, int& count, int& id)
+{
+    if (!root) return false;
+
+    if (_selectInorder(root->left, count, id)) return true;
+    if (count < root->count)
+    {
+        id = root->ids[count];
+        return true;
+    }
+    count -= root->count;
+    return _selectInorder(root->right, count, id);
+}
+
+/**
+ *  @brief  Store a name in the name pool, reusing a released handle if there is one
+ *  @param  name  full name
+ *  @return handle of the name
+ */
+uint32_t BlockAVLTree::_storeName(const string& name)
+{
+    if (_freeNames.empty())
+    {
+        _names.push_back(name);
+        return static_cast<uint32_t>(_names.size() - 1);
+    }
+    const uint32_t handle = _freeNames.back();
+    _freeNames.pop_back();
+    _names[handle] = name;
+    return handle;
+}
+
+/**
+ *  @brief  Release a name from the name pool, freeing its characters
+ *  @param  handle  handle of the name
+ */
+void BlockAVLTree::_releaseName(const uint32_t handle)
+{
+    string().swap(_names[handle]);
+    _freeNames.push_back(handle);
+}
+
+/**
+ *  @brief  Free the memory of a @c KeyBlock
+ *  @param  block  pointer to the @c KeyBlock
+ */
+void BlockAVLTree::_freeBlock(KeyBlock* block)
+{
+    delete block;
+    _blockCount--;
+}
+
+/**
+ *  @brief  Free the memory of every @c KeyBlock of a tree
+ *  @param  root  pointer to the root @c KeyBlock of the tree
+ */
+void BlockAVLTree::_destroy(KeyBlock* root)
+{
+    if (!root) return;
+
+    _destroy(root->left);
+    _destroy(root->right);
+    _freeBlock(root);
+}
+
+/**
+ *  @brief  Insert an entry to the block of a tree covering its ID, splitting the block in two if it is full
+ *  @param  root  pointer to the root @c KeyBlock of the tree
+ *  @param  id  integer ID
+ *  @param  name  full name
+ *  @param  is_inserted  boolean set to whether the ID was absent and is inserted
+ *  @return pointer to the root @c KeyBlock of the updated tree
+ *  @complexity O(log(n / B) + B) (worst-case)
+ */
+KeyBlock* BlockAVLTree::_insert(KeyBlock* root, const int id, const string& name, bool& is_inserted)
+{
+    if (!root)
+    {
+        KeyBlock* block = new KeyBlock();
+        _blockCount++;
+        _insertAt(block, 0, id, _storeName(name));
+        is_inserted = true;
+        return block;
+    }
+
+    // an ID outside the range of a block joins it when no block in that direction could hold the ID
+    if (id < root->ids[0] && root->left) root->left = _insert(root->left, id, name, is_inserted); else
+    if (id > root->ids[root->count - 1] && root->right) root->right = _insert(root->right, id, name, is_inserted); else
+    {
+        const int position = root->lowerBound(id);
+        if (position < root->count && root->ids[position] == id) return root;
+
+        if (root->count == KeyBlock::CAPACITY)
+        {
+            // the upper half moves to a new block, linked in as the inorder successor of this one
+            const int half = KeyBlock::CAPACITY / 2;
+            KeyBlock* upper = new KeyBlock();
+            _blockCount++;
+            _moveTail(root, upper, half);
+            if (position > half) _insertAt(upper, position - half, id, _storeName(name));
+            else _insertAt(root, position, id, _storeName(name));
+            root->right = _attachLeftmost(root->right, upper);
+        }
+        else _insertAt(root, position, id, _storeName(name));
+        is_inserted = true;
+    }
+    return _updateBalance(root);
+}
+
+/**
+ *  @brief  Remove an entry from the block of a tree holding its ID, merging an underfull block with a neighbor
+ *  @param  root  pointer to the root @c KeyBlock of the tree
+ *  @param  id  integer ID
+ *  @param  is_removed  boolean set to whether the ID was found and is removed
+ *  @return pointer to the root @c KeyBlock of the updated tree
+ *  @note   a block below @c MIN_FILL merges with, or takes entries from, its inorder neighbor in its own subtree;
+ *          a childless block has none there, so its parent merges with it on the way up instead
+ *  @complexity O(log(n / B) + B) (worst-case)
+ */
+KeyBlock* BlockAVLTree::_remove(KeyBlock* root, const int id, bool& is_removed)
+{
+    if (!root) return nullptr;
+
+    if (id < root->ids[0])
+    {
+        root->left = _remove(root->left, id, is_removed);
+        KeyBlock* child = root->left;
+        if (is_removed && child && !child->left && !child->right && child->count < MIN_FILL
+            && _rebalancePair(child, root, false))
+        {
+            root->left = nullptr;
+            _freeBlock(child);
+        }
+    }
+    else
+    if (id > root->ids[root->count - 1])
+    {
+        root->right = _remove(root->right, id, is_removed);
+        KeyBlock* child = root->right;
+        if (is_removed && child && !child->left && !child->right && child->count < MIN_FILL
+            && _rebalancePair(root, child, true))
+        {
+            root->right = nullptr;
+            _freeBlock(child);
+        }
+    }
+    else
+    {
+        const int position = root->lowerBound(id);
+        if (root->ids[position] != id) return root;
+
+        _releaseName(root->names[position]);
+        _eraseAt(root, position);
+        _size--;
+        is_removed = true;
+
+        if (!root->count)
+        {
+            KeyBlock* replacement = _unlink(root);
+            _freeBlock(root);
+            return replacement;
+        }
+        if (root->count < MIN_FILL)
+        {
+            KeyBlock* neighbor = nullptr;
+            if (root->right && _rebalancePair(root, _getLeftmost(root->right), true))
+            {
+                root->right = _detachLeftmost(root->right, neighbor);
+                _freeBlock(neighbor);
+            }
+            else
+            if (!root->right && root->left && _rebalancePair(_getRightmost(root->left), root, false))
+            {
+                root->left = _detachRightmost(root->left, neighbor);
+                _freeBlock(neighbor);
+            }
+        }
+    }
+    return _updateBalance(root);
+}
+
+/**
+ *  @brief Copies the comma-separated names of a block, in ID order, to a string
+ *  @param block  pointer to the @c KeyBlock
+ *  @param names  string to which names list is copied
+ */
+void BlockAVLTree::_copyBlock(const KeyBlock* block, string& names) const
+{
+    for (int i = 0; i < block->count; i++) names += (_names[block->names[i]] + ", ");
+}
+
+/**
+ *  @brief Copies a comma-separated inorder traversal to a string
+ *  @param root  pointer to the root @c KeyBlock of a tree
+ *  @param names  string to which names list is copied
+ */
+void BlockAVLTree::_copyInorder(KeyBlock* root, string& names) const
+{
+    if (!root) return;
+
+    _copyInorder(root->left, names);
+    _copyBlock(root, names);
+    _copyInorder(root->right, names);
+}
+
+/**
+ *  @brief Copies a comma-separated preorder traversal of the blocks to a string
+ *  @param root  pointer to the root @c KeyBlock of a tree
+ *  @param names  string to which names list is copied
+ */
+void BlockAVLTree::_copyPreorder(KeyBlock* root, string& names) const
+{
+    if (!root) return;
+
+    _copyBlock(root, names);
+    _copyPreorder(root->left, names);
+    _copyPreorder(root->right, names);
+}
+
+/**
+ *  @brief Copies a comma-separated postorder traversal of the blocks to a string
+ *  @param root  pointer to the root @c KeyBlock of a tree
+ *  @param names  string to which names list is copied
+ */
+void BlockAVLTree::_copyPostorder(KeyBlock* root, string& names) const
+{
+    if (!root) return;
+
+    _copyPostorder(root->left, names);
+    _copyPostorder(root->right, names);
+    _copyBlock(root, names);
+}
+
+/**
+ *  @brief Copies a comma-separated levelorder traversal of the blocks to a string
+ *  @param root  pointer to the root @c KeyBlock of a tree
+ *  @param names  string to which names list is copied
+ */
+void BlockAVLTree::_copyLevelorder(KeyBlock* root, string& names) const
+{
+    if (!root) return;
+
+    queue<KeyBlock*> blocks_queue;
+    blocks_queue.push(root);
+    while (!blocks_queue.empty())
+    {
+        KeyBlock* current = blocks_queue.front();
+        blocks_queue.pop();
+
+        _copyBlock(current, names);
+        if (current->left) blocks_queue.push(current->left);
+        if (current->right) blocks_queue.push(current->right);
+    }
+}
+
+/**
+ *  @brief Search, by name, and copy a list of IDs from a tree
+ *  @param root  pointer to the root @c KeyBlock of the tree
+ *  @param name  full name
+ *  @param matches vector to which list of IDs is to be copied
+ *  @complexity O(n) (worst-case)
+ */
+void BlockAVLTree::_search(KeyBlock* root, const string& name, vector<string>& matches) const
+{
+    if (!root) return;
+
+    for (int i = 0; i < root->count; i++)
+        if (_names[root->names[i]] == name) matches.push_back(AVLTree::idToString(root->ids[i]));
+    _search(root->left, name, matches);
+    _search(root->right, name, matches);
+}
+
+/**
+ *  @brief  Free every block of @c this tree
+ */
+BlockAVLTree::~BlockAVLTree()
+{
+    _destroy(_root);
+}
+
+/**
+ *  @brief  Create a tree taking over the blocks and names of another, which is left empty
+ *  @param  other  tree
+ */
+BlockAVLTree::BlockAVLTree(BlockAVLTree&& other) noexcept :
+        _root(other._root), _names(std::move(other._names)), _freeNames(std::move(other._freeNames)),
+        _size(other._size), _blockCount(other._blockCount)
+{
+    other._root = nullptr;
+    other._size = 0;
+    other._blockCount = 0;
+}
+
+/**
+ *  @brief  Free the blocks of @c this tree and take over those of another, which is left empty
+ *  @param  other  tree
+ *  @return reference to @c this tree
+ */
+BlockAVLTree& BlockAVLTree::operator=(BlockAVLTree&& other) noexcept
+{
+    if (this == &other) return *this;
+
+    _destroy(_root);
+    _root = other._root;
+    _names = std::move(other._names);
+    _freeNames = std::move(other._freeNames);
+    _size = other._size;
+    _blockCount = other._blockCount;
+    other._root = nullptr;
+    other._size = 0;
+    other._blockCount = 0;
+    return *this;
+}
+
+/**
+ *  @brief  Insert an ID and name to @c this tree
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the ID was inserted successfully
+ *  @complexity O(log(n / B) + B) (worst-case)
+ */
+bool BlockAVLTree::insert(const int id, const string& name)
+{
+    bool is_inserted = false;
+    _root = _insert(_root, id, name, is_inserted);
+    if (is_inserted) _size++;
+    return is_inserted;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove an entry from @c this tree
+ *  @param  id integer ID
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(log(n / B) + B) (worst-case)
+ */
+bool BlockAVLTree::remove(const int id)
+{
+    bool is_removed = false;
+    _root = _remove(_root, id, is_removed);
+    return is_removed;
+}
+
+/**
+ *  @brief  Identify, by inorder count, and remove an entry from @c this tree
+ *  @param  count inorder count
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(n / B + B) (worst-case)
+ */
+bool BlockAVLTree::removeInorder(int count)
+{
+    int id = 0;
+    if (count < 0 || !_selectInorder(_root, count, id)) return false;
+    return remove(id);
+}
+
+/**
+ *  @brief  Search for an ID from @c this tree
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @complexity O(log(n / B) + B) (worst-case)
+ */
+string BlockAVLTree::search(const int id) const
+{
+    const KeyBlock* root = _root;
+    while (root)
+    {
+        if (id < root->ids[0]) root = root->left; else
+        if (id > root->ids[root->count - 1]) root = root->right; else
+        {
+            const int position = root->lowerBound(id);
+            return (root->ids[position] == id) ? _names[root->names[position]] : "";
+        }
+    }
+    return "";
+}
+
+/**
+ *  @brief  Search for a name from @c this tree
+ *  @param  name  full name
+ *  @return list of 8-character IDs with the name, blocks in preorder and IDs within a block in order
+ */
+vector<string> BlockAVLTree::search(const string& name) const
+{
+    vector<string> matches;
+    _search(_root, name, matches);
+    return matches;
+}
+
+/**
+ *  @brief  Get a comma-separated list of names from @c this tree
+ *  @param  type type of tree traversal to generate the list from
+ *  @return comma-separated list of names as a string; except for @c INORDER, the traversal visits blocks,
+ *          listing the names of each block in ID order
+ *  @complexity O(n) (worst-case)
+ */
+string BlockAVLTree::traversalToString(const Traversal type) const
+{
+    if (!_root) return "";
+    string names;
+
+    switch (type)
+    {
+        case INORDER: _copyInorder(_root, names); break;
+        case PREORDER: _copyPreorder(_root, names); break;
+        case POSTORDER: _copyPostorder(_root, names); break;
+        case LEVELORDER: _copyLevelorder(_root, names); break;
+        default: return "";
+    }
+
+    names.pop_back(); // removes the last space
+    names.pop_back(); // removes the last comma
+    return names;
+}
+
+/**
+ *  @brief  Get the number of levels of blocks from root to most distant leaf of @c this tree
+ *  @return highest level of @c this tree
+ */
+int BlockAVLTree::levelCount() const
+{
+    return _getHeight(_root) + 1;
+}
+
+/**
+ *  @brief  Get the number of IDs in @c this tree
+ *  @return number of IDs
+ */
+size_t BlockAVLTree::size() const
+{
+    return _size;
+}
+
+/**
+ *  @brief  Get the memory held by the blocks and name pool of @c this tree, not counting characters of long names
+ *  @return number of bytes
+ */
+size_t BlockAVLTree::memoryBytes() const
+{
+    return _blockCount * sizeof(KeyBlock) + _names.capacity() * sizeof(string)
+           + _freeNames.capacity() * sizeof(uint32_t);
+}
+
+#endif //BLOCKAVLTREE_H
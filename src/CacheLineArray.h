@@ -0,0 +1,99 @@
+#ifndef CACHELINEARRAY_H
+#define CACHELINEARRAY_H
+
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/// Object class for a fixed number of objects, each on cache lines of its own, allocated apart from their owner
+/// so that the owner needs no extended alignment, which heap allocation does not honour before C++17
+template <typename T>
+class CacheLineArray {
+
+private:
+    static const size_t CACHE_LINE = 64;
+    static_assert(alignof(T) == CACHE_LINE, "the objects must be declared alignas(64)");
+    void* _block;
+
+public:
+    T* const items;
+    const size_t count;
+    explicit CacheLineArray(size_t n);
+    ~CacheLineArray();
+    CacheLineArray(const CacheLineArray&) = delete;
+    CacheLineArray& operator=(const CacheLineArray&) = delete;
+    T& operator[](size_t index) const;
+    T* begin() const;
+    T* end() const;
+    T& local() const;
+};
+
+/**
+ *  @brief  Allocate cache-line aligned memory for a number of objects and construct them in place
+ *  @param  n  number of objects
+ */
+template <typename T>
+CacheLineArray<T>::CacheLineArray(const size_t n) :
+        _block(::operator new(n * sizeof(T) + CACHE_LINE)),
+        items(reinterpret_cast<T*>((reinterpret_cast<uintptr_t>(_block) + CACHE_LINE - 1) & ~(CACHE_LINE - 1))),
+        count(n)
+{
+    for (size_t i = 0; i < count; i++) new (items + i) T();
+}
+
+/**
+ *  @brief  Destroy the objects and free the memory of @c this array
+ */
+template <typename T>
+CacheLineArray<T>::~CacheLineArray()
+{
+    for (size_t i = 0; i < count; i++) items[i].~T();
+    ::operator delete(_block);
+}
+
+/**
+ *  @brief  Get an object of @c this array
+ *  @param  index  position of the object, less than the count
+ *  @return object
+ */
+template <typename T>
+T& CacheLineArray<T>::operator[](const size_t index) const
+{
+    return items[index];
+}
+
+/**
+ *  @brief  Get the first object of @c this array
+ *  @return pointer to the first object
+ */
+template <typename T>
+T* CacheLineArray<T>::begin() const
+{
+    return items;
+}
+
+/**
+ *  @brief  Get the end of @c this array
+ *  @return pointer past the last object
+ */
+template <typename T>
+T* CacheLineArray<T>::end() const
+{
+    return items + count;
+}
+
+/**
+ *  @brief  Get the object of @c this array assigned to the calling thread, so that threads write apart from each
+ *          other; threads are numbered in the order they first call, and share objects only beyond the count
+ *  @return object
+ */
+template <typename T>
+T& CacheLineArray<T>::local() const
+{
+    static std::atomic<size_t> thread_count{0};
+    static thread_local const size_t thread_index = thread_count++;
+    return items[thread_index % count];
+}
+
+#endif //CACHELINEARRAY_H
@@ -0,0 +1,233 @@
+#ifndef CONCURRENTAVLTREE_H
+#define CONCURRENTAVLTREE_H
+
+#include "AVLTree.h"
+#include "EpochManager.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+using std::atomic;
+using std::shared_timed_mutex;
+using std::shared_lock;
+using std::unique_lock;
+
+/// Object class for an @c AVLTree shared between threads, whose writers exclude each other and, in
+/// @c SHARED_LOCK mode, the readers, or, in @c SEQLOCK mode, only the readers that do not validate
+class ConcurrentAVLTree {
+
+public:
+    enum Mode { SHARED_LOCK, SEQLOCK };
+
+private:
+    AVLTree _tree;
+    const Mode _mode;
+    shared_timed_mutex _mutex; // held shared by locking readers and exclusively by writers
+    atomic<uint64_t> _sequence; // odd while a writer is mutating the tree (SEQLOCK mode)
+    vector<Node*> _retired; // Nodes unlinked by the current writer (SEQLOCK mode)
+    EpochManager _epochs; // frees retired Nodes once no optimistic reader can hold them; destroyed before _tree
+    void _beginWrite();
+    void _endWrite();
+    static void _releaseBatch(void* batch, void* tree);
+
+public:
+    explicit ConcurrentAVLTree(Mode mode = SHARED_LOCK);
+    ~ConcurrentAVLTree();
+    ConcurrentAVLTree(const ConcurrentAVLTree&) = delete;
+    ConcurrentAVLTree& operator=(const ConcurrentAVLTree&) = delete;
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    bool removeInorder(int count);
+    string search(int id);
+    vector<string> search(const string& name);
+    string traversalToString(AVLTree::Traversal type);
+    int levelCount();
+    size_t retiredCount();
+    uint64_t reclamationLag();
+};
+
+/**
+ *  @brief  Create an empty tree
+ *  @param  mode  @c SHARED_LOCK for searches by ID that take the lock shared; @c SEQLOCK for searches by ID
+ *          that take no lock and retry when a write overlaps them
+ */
+ConcurrentAVLTree::ConcurrentAVLTree(const Mode mode) : _mode(mode), _sequence(0)
+{
+    if (_mode == SEQLOCK) _tree.deferFrees(&_retired);
+}
+
+/**
+ *  @brief  Free every @c Node of @c this tree; those retired are freed with the epoch manager, and the rest by
+ *          the destructor of the @c AVLTree, once no reader is left
+ */
+ConcurrentAVLTree::~ConcurrentAVLTree()
+{
+    _tree.deferFrees(nullptr);
+}
+
+/**
+ *  @brief  Take the writer lock and, in @c SEQLOCK mode, mark the sequence as mid-write
+ */
+void ConcurrentAVLTree::_beginWrite()
+{
+    _mutex.lock();
+    if (_mode != SEQLOCK) return;
+    _sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // the odd sequence is visible before any write
+}
+
+/**
+ *  @brief  Publish the writes and, in @c SEQLOCK mode, retire the unlinked @c Nodes as one batch, then release
+ *          the writer lock
+ *  @note   batches are released while the writer lock is held, since freeing a @c Node may touch the arenas
+ */
+void ConcurrentAVLTree::_endWrite()
+{
+    if (_mode == SEQLOCK)
+    {
+        _sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+        if (!_retired.empty())
+        {
+            const size_t count = _retired.size();
+            _epochs.retire(new vector<Node*>(std::move(_retired)), _releaseBatch, &_tree, count);
+            _retired.clear();
+        }
+    }
+    _mutex.unlock();
+}
+
+/**
+ *  @brief  Free a batch of retired @c Nodes
+ *  @param  batch  pointer to the list of @c Nodes, which is deleted too
+ *  @param  tree  pointer to the @c AVLTree that unlinked them
+ */
+void ConcurrentAVLTree::_releaseBatch(void* batch, void* tree)
+{
+    vector<Node*>* nodes = static_cast<vector<Node*>*>(batch);
+    static_cast<AVLTree*>(tree)->releaseDeferred(*nodes);
+    delete nodes;
+}
+
+/**
+ *  @brief  Create, with ID and name, and insert a @c Node to @c this tree
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the node was inserted successfully
+ */
+bool ConcurrentAVLTree::insert(const int id, const string& name)
+{
+    _beginWrite();
+    const bool is_inserted = _tree.insert(id, name);
+    _endWrite();
+    return is_inserted;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove a @c Node from @c this tree
+ *  @param  id integer ID
+ *  @return boolean indicating whether a node was removed
+ */
+bool ConcurrentAVLTree::remove(const int id)
+{
+    _beginWrite();
+    const bool is_removed = _tree.remove(id);
+    _endWrite();
+    return is_removed;
+}
+
+/**
+ *  @brief  Identify, by inorder count, and remove a @c Node from @c this tree
+ *  @param  count inorder count
+ *  @return boolean indicating whether a node was removed
+ */
+bool ConcurrentAVLTree::removeInorder(const int count)
+{
+    _beginWrite();
+    const bool is_removed = _tree.removeInorder(count);
+    _endWrite();
+    return is_removed;
+}
+
+/**
+ *  @brief  Search for an ID from @c this tree
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @note   in @c SEQLOCK mode the descent reads the tree while writers may change it, and is retried unless
+ *          the sequence is even and unchanged across it; the name is copied only from a validated @c Node,
+ *          which stays allocated while the reader is pinned even if a writer unlinks it meanwhile
+ *  @complexity O(log n) (worst-case) per attempt
+ */
+string ConcurrentAVLTree::search(const int id)
+{
+    if (_mode != SEQLOCK)
+    {
+        shared_lock<shared_timed_mutex> lock(_mutex);
+        return _tree.search(id);
+    }
+
+    EpochManager::Guard guard(_epochs);
+    string match;
+    while (true)
+    {
+        const uint64_t sequence = _sequence.load(std::memory_order_acquire);
+        if (sequence & 1) { std::this_thread::yield(); continue; }
+
+        const Node* node = _tree.find(id);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) != sequence) continue;
+        if (node) match = node->name;
+        break;
+    }
+    return match;
+}
+
+/**
+ *  @brief  Search for a name from @c this tree, alongside other readers
+ *  @param  name  full name
+ *  @return list of 8-character IDs with the name, in preorder
+ */
+vector<string> ConcurrentAVLTree::search(const string& name)
+{
+    shared_lock<shared_timed_mutex> lock(_mutex);
+    return _tree.search(name);
+}
+
+/**
+ *  @brief  Get a comma-separated list of names from @c this tree, alongside other readers
+ *  @param  type type of tree traversal to generate the list from
+ *  @return comma-separated list of names as a string
+ */
+string ConcurrentAVLTree::traversalToString(const AVLTree::Traversal type)
+{
+    shared_lock<shared_timed_mutex> lock(_mutex);
+    return _tree.traversalToString(type);
+}
+
+/**
+ *  @brief  Get the number of levels of @c this tree, alongside other readers
+ *  @return highest level of @c this tree
+ */
+int ConcurrentAVLTree::levelCount()
+{
+    shared_lock<shared_timed_mutex> lock(_mutex);
+    return _tree.levelCount();
+}
+
+/**
+ *  @brief  Get the number of @c Nodes unlinked but not yet freed, because optimistic readers may still hold them
+ *  @return number of retired @c Nodes
+ */
+size_t ConcurrentAVLTree::retiredCount()
+{
+    return _epochs.pendingCount();
+}
+
+/**
+ *  @brief  Get the number of epochs the oldest retired @c Node has waited to be freed
+ *  @return epochs since the oldest retired @c Node was retired; 0 if none is
+ */
+uint64_t ConcurrentAVLTree::reclamationLag()
+{
+    return _epochs.reclamationLag();
+}
+
+#endif //CONCURRENTAVLTREE_H
@@ -0,0 +1,284 @@
+#ifndef EPOCHMANAGER_H
+#define EPOCHMANAGER_H
+
+#include "CacheLineArray.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <algorithm>
+using std::atomic;
+using std::deque;
+using std::mutex;
+using std::lock_guard;
+
+/// Object class for epoch-based reclamation: memory retired by writers is released only once every reader that
+/// was pinned when it was retired has unpinned, so that readers may follow pointers without locks
+class EpochManager {
+
+public:
+    static const size_t SLOT_COUNT = 128; // most threads pinned at once; more wait for a slot
+    static const size_t LIST_COUNT = 64; // retire lists; threads beyond this many share them
+    static const size_t COLLECT_THRESHOLD = 64; // objects retired to a list that trigger an attempt to reclaim it
+
+    /// Pin of the calling thread to the current epoch for the lifetime of the guard
+    class Guard {
+
+    private:
+        EpochManager& _manager;
+        const size_t _slot;
+
+    public:
+        explicit Guard(EpochManager& manager) : _manager(manager), _slot(manager.pin()) {}
+        ~Guard() { _manager.unpin(_slot); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+private:
+    /// Object retired at an epoch, with the function that releases it
+    struct Garbage {
+        uint64_t epoch;
+        void* pointer;
+        void (*release)(void* pointer, void* context);
+        void* context;
+        size_t count; // objects the release frees, for the metrics
+    };
+
+    /// Epoch announced by a pinned thread; 0 while unpinned. A cache line each, so that pins do not contend;
+    /// held in a @c CacheLineArray, since the owners of a manager are not over-aligned
+    struct alignas(64) Slot {
+        atomic<uint64_t> epoch{0};
+    };
+
+    /// Objects retired by the threads assigned to the list, in order of epoch. A cache line each, so that
+    /// retiring threads do not contend; the lock is taken by others only to collect or to read the metrics
+    struct alignas(64) RetireList {
+        mutex lock;
+        deque<Garbage> garbage;
+        size_t pendingCount = 0;
+        size_t retiredSinceCollect = 0;
+    };
+
+    atomic<uint64_t> _epoch{1};
+    CacheLineArray<Slot> _slots{SLOT_COUNT};
+    CacheLineArray<RetireList> _lists{LIST_COUNT};
+    atomic<size_t> _releasedCount{0};
+    bool _tryAdvance();
+    void _collect(RetireList& list, uint64_t epoch);
+    template<typename T>
+    static void _delete(void* pointer, void*);
+
+public:
+    EpochManager() = default;
+    ~EpochManager();
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+    size_t pin();
+    void unpin(size_t slot);
+    template<typename T>
+    void retire(T* pointer);
+    void retire(void* pointer, void (*release)(void* pointer, void* context), void* context, size_t count);
+    void collect();
+    uint64_t epoch() const;
+    size_t pendingCount();
+    uint64_t reclamationLag();
+    size_t releasedCount() const;
+};
+
+/**
+ *  @brief  Release every retired object; no thread may be pinned
+ */
+EpochManager::~EpochManager()
+{
+    for (const RetireList& list : _lists)
+    {
+        for (const Garbage& garbage : list.garbage) garbage.release(garbage.pointer, garbage.context);
+    }
+}
+
+/**
+ *  @brief  Delete an object retired by @c retire(T*)
+ *  @param  pointer  pointer to the object
+ */
+template<typename T>
+void EpochManager::_delete(void* pointer, void*)
+{
+    delete static_cast<T*>(pointer);
+}
+
+/**
+ *  @brief  Advance the epoch if every pinned thread has announced the current one
+ *  @return boolean indicating whether the epoch advanced
+ *  @complexity O(SLOT_COUNT) (worst-case)
+ */
+bool EpochManager::_tryAdvance()
+{
+    uint64_t epoch = _epoch.load();
+    for (const Slot& slot : _slots)
+    {
+        const uint64_t announced = slot.epoch.load();
+        if (announced && announced != epoch) return false;
+    }
+    return _epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+/**
+ *  @brief  Pin the calling thread to the current epoch, before it reads shared pointers
+ *  @return slot to pass to @c unpin
+ *  @note   a thread that announces an epoch which has since advanced only holds reclamation back: memory
+ *          retired before the advance was unlinked before the thread started reading
+ */
+size_t EpochManager::pin()
+{
+    static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (size_t attempt = 0;; attempt++)
+    {
+        const size_t slot = (hint + attempt) % SLOT_COUNT;
+        uint64_t unpinned = 0;
+        if (!_slots[slot].epoch.load(std::memory_order_relaxed) &&
+            _slots[slot].epoch.compare_exchange_strong(unpinned, _epoch.load()))
+        {
+            hint = slot;
+            return slot;
+        }
+        if (attempt % SLOT_COUNT == SLOT_COUNT - 1) std::this_thread::yield();
+    }
+}
+
+/**
+ *  @brief  Unpin the calling thread, after it has dropped every shared pointer it read
+ *  @param  slot  slot returned by @c pin
+ */
+void EpochManager::unpin(const size_t slot)
+{
+    _slots[slot].epoch.store(0, std::memory_order_release);
+}
+
+/**
+ *  @brief  Hand an object, already unreachable by new readers, to be deleted once no reader can hold it
+ *  @param  pointer  pointer to the object
+ */
+template<typename T>
+void EpochManager::retire(T* pointer)
+{
+    retire(pointer, _delete<T>, nullptr, 1);
+}
+
+/**
+ *  @brief  Hand a batch of objects, already unreachable by new readers, to be released once no reader can
+ *          hold them
+ *  @param  pointer  pointer to the batch
+ *  @param  release  function called with the pointer and context to release the batch
+ *  @param  context  second argument of the release function
+ *  @param  count  number of objects in the batch
+ *  @note   the batch joins the retire list of the calling thread, and every @c COLLECT_THRESHOLD objects the
+ *          thread attempts to reclaim that list, so the release functions run on threads that retire; objects
+ *          are released two epochs after they are retired
+ */
+void EpochManager::retire(void* pointer, void (*release)(void* pointer, void* context), void* context,
+                          const size_t count)
+{
+    RetireList& list = _lists.local();
+    {
+        lock_guard<mutex> lock(list.lock);
+        list.garbage.push_back({_epoch.load(), pointer, release, context, count});
+        list.pendingCount += count;
+        list.retiredSinceCollect += count;
+        if (list.retiredSinceCollect < COLLECT_THRESHOLD) return;
+        list.retiredSinceCollect = 0;
+    }
+    _tryAdvance();
+    _collect(list, _epoch.load());
+}
+
+/**
+ *  @brief  Release the objects of a retire list retired at least two epochs before an epoch
+ *  @param  list  retire list
+ *  @param  epoch  current epoch
+ *  @complexity O(k) (worst-case), for k released objects
+ */
+void EpochManager::_collect(RetireList& list, const uint64_t epoch)
+{
+    deque<Garbage> reclaimable;
+    {
+        lock_guard<mutex> lock(list.lock);
+        while (!list.garbage.empty() && list.garbage.front().epoch + 2 <= epoch)
+        {
+            list.pendingCount -= list.garbage.front().count;
+            reclaimable.push_back(list.garbage.front());
+            list.garbage.pop_front();
+        }
+    }
+    size_t released = 0;
+    for (const Garbage& garbage : reclaimable)
+    {
+        garbage.release(garbage.pointer, garbage.context);
+        released += garbage.count;
+    }
+    if (released) _releasedCount += released;
+}
+
+/**
+ *  @brief  Attempt to advance the epoch and release the objects of every retire list retired at least two
+ *          epochs ago
+ *  @complexity O(SLOT_COUNT + LIST_COUNT + k) (worst-case), for k released objects
+ */
+void EpochManager::collect()
+{
+    _tryAdvance();
+    const uint64_t epoch = _epoch.load();
+    for (RetireList& list : _lists) _collect(list, epoch);
+}
+
+/**
+ *  @brief  Get the current epoch
+ *  @return epoch, starting from 1
+ */
+uint64_t EpochManager::epoch() const
+{
+    return _epoch.load();
+}
+
+/**
+ *  @brief  Get the number of objects retired but not yet released
+ *  @return number of pending objects
+ */
+size_t EpochManager::pendingCount()
+{
+    size_t count = 0;
+    for (RetireList& list : _lists)
+    {
+        lock_guard<mutex> lock(list.lock);
+        count += list.pendingCount;
+    }
+    return count;
+}
+
+/**
+ *  @brief  Get the number of epochs the oldest pending object has waited; objects are released after 2, unless
+ *          a pinned thread holds the epoch back
+ *  @return epochs since the oldest pending object was retired; 0 if none is pending
+ */
+uint64_t EpochManager::reclamationLag()
+{
+    uint64_t lag = 0;
+    for (RetireList& list : _lists)
+    {
+        lock_guard<mutex> lock(list.lock);
+        if (!list.garbage.empty()) lag = std::max(lag, _epoch.load() - list.garbage.front().epoch);
+    }
+    return lag;
+}
+
+/**
+ *  @brief  Get the number of objects released since @c this manager was created
+ *  @return number of released objects
+ */
+size_t EpochManager::releasedCount() const
+{
+    return _releasedCount.load();
+}
+
+#endif //EPOCHMANAGER_H
@@ -0,0 +1,204 @@
+#ifndef FLATCOMBININGAVLTREE_H
+#define FLATCOMBININGAVLTREE_H
+
+#include "AVLTree.h"
+#include "CacheLineArray.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <algorithm>
+using std::atomic;
+using std::mutex;
+using std::lock_guard;
+
+/// Object class for an @c AVLTree shared between threads, whose callers publish their operations in slots and
+/// whichever caller takes the lock applies every published operation as one sorted batch (flat combining)
+class FlatCombiningAVLTree {
+
+public:
+    static const size_t SLOT_COUNT = 64; // most operations published at once; more wait for a slot
+
+private:
+    enum Operation { INSERT, REMOVE, SEARCH };
+    enum State { FREE, CLAIMED, PENDING, DONE };
+
+    /// Operation published by a caller, and its result once combined. A cache line each, so that callers
+    /// spinning on their own slot do not contend; held in a @c CacheLineArray, since the tree itself is not
+    /// over-aligned
+    struct alignas(64) Slot {
+        atomic<int> state{FREE};
+        Operation operation = SEARCH;
+        int id = 0;
+        const string* name = nullptr; // name to insert
+        string* match = nullptr; // string to which a found name is copied
+        bool result = false; // of an insertion or removal
+    };
+
+    AVLTree _tree;
+    mutex _combiner; // held by the caller applying a batch, and by readers of the whole tree
+    CacheLineArray<Slot> _slots{SLOT_COUNT};
+    size_t _batchCount = 0;
+    size_t _combinedCount = 0;
+    Slot* _publish(Operation operation, int id, const string* name, string* match);
+    void _combine();
+
+public:
+    FlatCombiningAVLTree() = default;
+    FlatCombiningAVLTree(const FlatCombiningAVLTree&) = delete;
+    FlatCombiningAVLTree& operator=(const FlatCombiningAVLTree&) = delete;
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    string search(int id);
+    string traversalToString(AVLTree::Traversal type);
+    int levelCount();
+    double averageBatch();
+};
+
+/**
+ *  @brief  Publish an operation and wait until some caller, possibly this one, has applied it
+ *  @param  operation  operation to apply
+ *  @param  id  integer ID
+ *  @param  name  name to insert; @c nullptr for other operations
+ *  @param  match  string to which a found name is copied; @c nullptr for other operations
+ *  @return pointer to the slot holding the result; the caller frees it after reading the result
+ */
+FlatCombiningAVLTree::Slot* FlatCombiningAVLTree::_publish(const Operation operation, const int id,
+                                                           const string* name, string* match)
+{
+    static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+    Slot* slot = nullptr;
+    for (size_t attempt = 0; !slot; attempt++)
+    {
+        Slot& candidate = _slots[(hint + attempt) % SLOT_COUNT];
+        int free = FREE;
+        if (candidate.state.load(std::memory_order_relaxed) == FREE &&
+            candidate.state.compare_exchange_strong(free, CLAIMED))
+        {
+            hint = (hint + attempt) % SLOT_COUNT;
+            slot = &candidate;
+        }
+        else
+        if (attempt % SLOT_COUNT == SLOT_COUNT - 1) std::this_thread::yield();
+    }
+    slot->operation = operation;
+    slot->id = id;
+    slot->name = name;
+    slot->match = match;
+    slot->state.store(PENDING, std::memory_order_release);
+
+    while (slot->state.load(std::memory_order_acquire) != DONE)
+    {
+        if (_combiner.try_lock())
+        {
+            _combine();
+            _combiner.unlock();
+        }
+        else std::this_thread::yield();
+    }
+    return slot;
+}
+
+/**
+ *  @brief  Apply every published operation, sorted by ID so that consecutive operations follow the finger of
+ *          the tree; the combiner lock is held
+ *  @note   operations pending together overlap in time, so any order among them is linearizable
+ *  @complexity O(k log k + k log d) (amortized), for k operations d IDs apart
+ */
+void FlatCombiningAVLTree::_combine()
+{
+    Slot* batch[SLOT_COUNT];
+    size_t count = 0;
+    for (Slot& slot : _slots) if (slot.state.load(std::memory_order_acquire) == PENDING) batch[count++] = &slot;
+    if (!count) return;
+
+    std::sort(batch, batch + count, [](const Slot* a, const Slot* b) { return a->id < b->id; });
+    int previous = batch[0]->id;
+    for (size_t i = 0; i < count; i++)
+    {
+        Slot& slot = *batch[i];
+        switch (slot.operation)
+        {
+            case INSERT: slot.result = _tree.insertHint(previous, slot.id, *slot.name); break;
+            case REMOVE: slot.result = _tree.remove(slot.id); break;
+            case SEARCH: *slot.match = _tree.searchNear(slot.id);
+        }
+        previous = slot.id;
+        slot.state.store(DONE, std::memory_order_release);
+    }
+    _batchCount++;
+    _combinedCount += count;
+}
+
+/**
+ *  @brief  Create, with ID and name, and insert a @c Node to @c this tree, through the combiner
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the node was inserted successfully
+ */
+bool FlatCombiningAVLTree::insert(const int id, const string& name)
+{
+    Slot* slot = _publish(INSERT, id, &name, nullptr);
+    const bool is_inserted = slot->result;
+    slot->state.store(FREE, std::memory_order_release);
+    return is_inserted;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove a @c Node from @c this tree, through the combiner
+ *  @param  id integer ID
+ *  @return boolean indicating whether a node was removed
+ */
+bool FlatCombiningAVLTree::remove(const int id)
+{
+    Slot* slot = _publish(REMOVE, id, nullptr, nullptr);
+    const bool is_removed = slot->result;
+    slot->state.store(FREE, std::memory_order_release);
+    return is_removed;
+}
+
+/**
+ *  @brief  Search for an ID from @c this tree, through the combiner
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ */
+string FlatCombiningAVLTree::search(const int id)
+{
+    string match;
+    Slot* slot = _publish(SEARCH, id, nullptr, &match);
+    slot->state.store(FREE, std::memory_order_release);
+    return match;
+}
+
+/**
+ *  @brief  Get a comma-separated list of names from @c this tree, excluding the combiner
+ *  @param  type type of tree traversal to generate the list from
+ *  @return comma-separated list of names as a string
+ */
+string FlatCombiningAVLTree::traversalToString(const AVLTree::Traversal type)
+{
+    lock_guard<mutex> lock(_combiner);
+    return _tree.traversalToString(type);
+}
+
+/**
+ *  @brief  Get the number of levels of @c this tree, excluding the combiner
+ *  @return highest level of @c this tree
+ */
+int FlatCombiningAVLTree::levelCount()
+{
+    lock_guard<mutex> lock(_combiner);
+    return _tree.levelCount();
+}
+
+/**
+ *  @brief  Get the average number of operations applied per combining pass
+ *  @return operations per batch; 0 before the first
+ */
+double FlatCombiningAVLTree::averageBatch()
+{
+    lock_guard<mutex> lock(_combiner);
+    return _batchCount ? static_cast<double>(_combinedCount) / static_cast<double>(_batchCount) : 0;
+}
+
+#endif //FLATCOMBININGAVLTREE_H
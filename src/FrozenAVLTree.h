@@ -0,0 +1,219 @@
+#ifndef FROZENAVLTREE_H
+#define FROZENAVLTREE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+using std::string;
+using std::vector;
+using std::min;
+
+#ifndef AVL_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define AVL_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define AVL_PREFETCH(address) ((void)(address))
+#endif
+#endif
+
+/// Object class for an immutable snapshot of a tree, with IDs in Eytzinger (breadth-first) order for branchless search
+class FrozenAVLTree {
+
+private:
+    vector<int> _ids; // 1-indexed; the children of index k are at 2k and 2k + 1
+    vector<string> _names; // side table aligned with the IDs
+    size_t _count = 0;
+    int _depth = 0;
+    void _place(const vector<int>& ids, vector<string>& names, size_t& next, size_t index);
+    void _copyInorder(size_t index, vector<int>& ids) const;
+    static size_t _lowerBoundIndex(size_t index);
+    size_t _lowerBound(int id) const;
+    static const size_t BATCH_WIDTH = 8;
+
+public:
+    FrozenAVLTree() = default;
+    FrozenAVLTree(const vector<int>& ids, vector<string> names);
+    size_t size() const;
+    string search(int id) const;
+    vector<string> searchBatch(const vector<int>& ids) const;
+    vector<int> sortedIds() const;
+};
+
+/**
+ *  @brief  Create a snapshot from IDs, sorted and unique, and their names
+ *  @param  ids  list of integer IDs
+ *  @param  names  list of full names, aligned with the IDs
+ *  @complexity O(n) (worst-case)
+ */
+FrozenAVLTree::FrozenAVLTree(const vector<int>& ids, vector<string> names) :
+        _ids(ids.size() + 1), _names(ids.size() + 1), _count(ids.size())
+{
+    size_t next = 0;
+    _place(ids, names, next, 1);
+    while ((size_t(1) << _depth) <= _count) _depth++;
+}
+
+/**
+ *  @brief Copy sorted IDs and names, in inorder sequence, to the implicit subtree rooted at an index
+ *  @param ids  list of integer IDs
+ *  @param names  list of full names, aligned with the IDs; moved from
+ *  @param next  position of the next ID to be copied
+ *  @param index  Eytzinger index of the subtree root
+ */
+void FrozenAVLTree::_place(const vector<int>& ids, vector<string>& names, size_t& next, const size_t index)
+{
+    if (index > _count) return;
+
+    _place(ids, names, next, 2 * index);
+    _ids[index] = ids[next];
+    _names[index] = std::move(names[next]);
+    next++;
+    _place(ids, names, next, 2 * index + 1);
+}
+
+/**
+ *  @brief Copy the IDs of the implicit subtree rooted at an index, in inorder sequence, to a list
+ *  @param index  Eytzinger index of the subtree root
+ *  @param ids  list to which the IDs are copied
+ */
+void FrozenAVLTree::_copyInorder(const size_t index, vector<int>& ids) const
+{
+    if (index > _count) return;
+
+    _copyInorder(2 * index, ids);
+    ids.push_back(_ids[index]);
+    _copyInorder(2 * index + 1, ids);
+}
+
+/**
+ *  @brief  Recover the lower bound from the index at which a descent left the implicit tree
+ *  @param  index  Eytzinger index past the last level
+ *  @return Eytzinger index of the least ID not less than the searched ID; 0 if there is none
+ */
+size_t FrozenAVLTree::_lowerBoundIndex(size_t index)
+{
+    // the descent turned right once per trailing one bit after its last left turn, which is the answer
+#if defined(__GNUC__) || defined(__clang__)
+    return index >> (__builtin_ctzll(~static_cast<unsigned long long>(index)) + 1);
+#else
+    while (index & 1) index >>= 1;
+    return index >> 1;
+#endif
+}
+
+/**
+ *  @brief  Find, without branching on comparisons, the least ID not less than an ID
+ *  @param  id  integer ID
+ *  @return Eytzinger index of the least ID not less than the ID; 0 if there is none
+ *  @complexity O(log n) (worst-case)
+ */
+size_t FrozenAVLTree::_lowerBound(const int id) const
+{
+    const int* ids = _ids.data();
+    size_t index = 1;
+    while (index <= _count)
+    {
+        AVL_PREFETCH(ids + min(16 * index, _count)); // the 16 descendants four levels down share a cache line
+        index = 2 * index + (ids[index] < id);
+    }
+    return _lowerBoundIndex(index);
+}
+
+/**
+ *  @brief  Get the number of IDs in @c this snapshot
+ *  @return number of IDs
+ */
+size_t FrozenAVLTree::size() const
+{
+    return _count;
+}
+
+/**
+ *  @brief  Search for an ID from @c this snapshot
+ *  @param  id  integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @complexity O(log n) (worst-case)
+ */
+string FrozenAVLTree::search(const int id) const
+{
+    const size_t index = _lowerBound(id);
+    if (!index || _ids[index] != id) return "";
+    return _names[index];
+}
+
+/**
+ *  @brief  Search for a batch of IDs from @c this snapshot, descending one level of several searches per round
+ *  @param  ids  list of integer IDs
+ *  @return list of names corresponding to the IDs, in the same order; empty where an ID is not found
+ *  @complexity O(k log n) (worst-case)
+ */
+vector<string> FrozenAVLTree::searchBatch(const vector<int>& ids) const
+{
+    vector<string> matches(ids.size());
+    const int* keys = _ids.data();
+    size_t indices[BATCH_WIDTH];
+
+    for (size_t first = 0; first < ids.size(); first += BATCH_WIDTH)
+    {
+        const size_t width = (ids.size() - first < BATCH_WIDTH) ? ids.size() - first : BATCH_WIDTH;
+
+#ifdef __AVX2__
+        if (width == BATCH_WIDTH)
+        {
+            const __m256i targets = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids.data() + first));
+            const __m256i count = _mm256_set1_epi32(static_cast<int>(_count));
+            __m256i index = _mm256_set1_epi32(1);
+            for (int level = 0; level < _depth; level++)
+            {
+                const __m256i is_inside = _mm256_xor_si256(_mm256_cmpgt_epi32(index, count), _mm256_set1_epi32(-1));
+                const __m256i values = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), keys, index, is_inside, 4);
+                const __m256i is_less = _mm256_cmpgt_epi32(targets, values); // -1 where the ID lies to the right
+                const __m256i next = _mm256_sub_epi32(_mm256_add_epi32(index, index), is_less);
+                index = _mm256_blendv_epi8(index, next, is_inside);
+            }
+            alignas(32) int lanes[BATCH_WIDTH];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), index);
+            for (size_t i = 0; i < BATCH_WIDTH; i++) indices[i] = static_cast<size_t>(lanes[i]);
+        }
+        else
+#endif
+        {
+            for (size_t i = 0; i < width; i++) indices[i] = 1;
+            for (int level = 0; level < _depth; level++)
+            {
+                for (size_t i = 0; i < width; i++)
+                {
+                    const size_t index = indices[i];
+                    if (index > _count) continue;
+                    AVL_PREFETCH(keys + min(16 * index, _count));
+                    indices[i] = 2 * index + (keys[index] < ids[first + i]);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < width; i++)
+        {
+            const size_t index = _lowerBoundIndex(indices[i]);
+            if (index && keys[index] == ids[first + i]) matches[first + i] = _names[index];
+        }
+    }
+    return matches;
+}
+
+/**
+ *  @brief  Get the IDs of @c this snapshot in sorted order, as for building a @c LearnedIndex
+ *  @return list of integer IDs
+ *  @complexity O(n) (worst-case)
+ */
+vector<int> FrozenAVLTree::sortedIds() const
+{
+    vector<int> ids;
+    ids.reserve(_count);
+    _copyInorder(1, ids);
+    return ids;
+}
+
+#endif //FROZENAVLTREE_H
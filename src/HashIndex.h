@@ -0,0 +1,151 @@
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include "Node.h"
+#include <vector>
+#include <cstdint>
+using std::vector;
+
+/// Object class for an open-addressing (linear probing) hash table from ID to @c Node
+class HashIndex {
+
+private:
+    struct Slot {
+        int id;
+        Node* node; // nullptr marks an empty slot
+    };
+    vector<Slot> _slots;
+    size_t _count = 0;
+    int _shift; // 64 minus the base-2 logarithm of the capacity
+    size_t _home(int id) const;
+    void _grow();
+
+public:
+    HashIndex();
+    Node* find(int id) const;
+    void insert(Node* node);
+    bool erase(int id);
+    void clear();
+    size_t size() const;
+    size_t memoryBytes() const;
+};
+
+/**
+ *  @brief  Create an empty table
+ */
+HashIndex::HashIndex() : _slots(16, Slot{0, nullptr}), _shift(64 - 4) {}
+
+/**
+ *  @brief  Get the slot at which the probe sequence of an ID starts, by Fibonacci hashing
+ *  @param  id  integer ID
+ *  @return index of the slot
+ */
+size_t HashIndex::_home(const int id) const
+{
+    return static_cast<size_t>((uint64_t(uint32_t(id)) * 0x9E3779B97F4A7C15ull) >> _shift);
+}
+
+/**
+ *  @brief  Double the capacity of @c this table and reinsert its entries
+ */
+void HashIndex::_grow()
+{
+    vector<Slot> slots(_slots.size() * 2, Slot{0, nullptr});
+    slots.swap(_slots);
+    _shift--;
+    _count = 0;
+    for (const Slot& slot : slots) if (slot.node) insert(slot.node);
+}
+
+/**
+ *  @brief  Find the @c Node with an ID
+ *  @param  id  integer ID
+ *  @return pointer to the @c Node; @c nullptr if not found
+ *  @complexity O(1) (expected)
+ */
+Node* HashIndex::find(const int id) const
+{
+    const size_t mask = _slots.size() - 1;
+    for (size_t i = _home(id);; i = (i + 1) & mask)
+    {
+        const Slot& slot = _slots[i];
+        if (!slot.node) return nullptr;
+        if (slot.id == id) return slot.node;
+    }
+}
+
+/**
+ *  @brief  Map the ID of a @c Node to the @c Node, replacing any @c Node mapped to the same ID
+ *  @param  node  pointer to the @c Node
+ *  @complexity O(1) (amortized expected)
+ */
+void HashIndex::insert(Node* node)
+{
+    if (2 * (_count + 1) > _slots.size()) _grow(); // keep the load factor at most 1/2
+
+    const size_t mask = _slots.size() - 1;
+    for (size_t i = _home(node->id);; i = (i + 1) & mask)
+    {
+        Slot& slot = _slots[i];
+        if (slot.node && slot.id != node->id) continue;
+        if (!slot.node) _count++;
+        slot.id = node->id;
+        slot.node = node;
+        return;
+    }
+}
+
+/**
+ *  @brief  Remove the mapping of an ID, shifting back later entries of its probe sequence instead of leaving a marker
+ *  @param  id  integer ID
+ *  @return boolean indicating whether the ID was mapped
+ *  @complexity O(1) (expected)
+ */
+bool HashIndex::erase(const int id)
+{
+    const size_t mask = _slots.size() - 1;
+    size_t hole = _home(id);
+    while (_slots[hole].node && _slots[hole].id != id) hole = (hole + 1) & mask;
+    if (!_slots[hole].node) return false;
+
+    for (size_t i = (hole + 1) & mask; _slots[i].node; i = (i + 1) & mask)
+    {
+        // an entry may fill the hole only if its home does not lie cyclically within (hole, i]
+        const size_t home = _home(_slots[i].id);
+        if (((i - home) & mask) < ((i - hole) & mask)) continue;
+        _slots[hole] = _slots[i];
+        hole = i;
+    }
+    _slots[hole].node = nullptr;
+    _count--;
+    return true;
+}
+
+/**
+ *  @brief  Remove every mapping, keeping the capacity
+ */
+void HashIndex::clear()
+{
+    for (Slot& slot : _slots) slot.node = nullptr;
+    _count = 0;
+}
+
+/**
+ *  @brief  Get the number of mapped IDs
+ *  @return number of mapped IDs
+ */
+size_t HashIndex::size() const
+{
+    return _count;
+}
+
+/**
+ *  @brief  Get the memory held by the slots of @c this table
+ *  @return number of bytes
+ */
+size_t HashIndex::memoryBytes() const
+{
+    return _slots.size() * sizeof(Slot);
+}
+
+#endif //HASHINDEX_H
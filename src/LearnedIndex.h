@@ -0,0 +1,157 @@
+#ifndef LEARNEDINDEX_H
+#define LEARNEDINDEX_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+using std::vector;
+using std::min;
+using std::max;
+
+/// Object class for a learned index over sorted IDs: piecewise-linear models with bounded error, stacked in levels
+class LearnedIndex {
+
+public:
+    /// Object class for a linear model predicting the positions of the IDs from its first ID up to the next model's
+    struct Segment {
+        int id;
+        size_t position;
+        double slope;
+    };
+
+private:
+    vector<int> _ids;
+    vector<vector<Segment>> _levels; // the first level models the IDs; each further level models the one below it
+    size_t _epsilon;
+    static vector<Segment> _fit(const vector<int>& ids, size_t epsilon);
+    static size_t _predict(const vector<Segment>& segments, size_t index, int id, size_t count);
+
+public:
+    explicit LearnedIndex(vector<int> ids, size_t epsilon = 32);
+    long find(int id) const;
+    bool contains(int id) const;
+    size_t segmentCount() const;
+};
+
+/**
+ *  @brief  Create an index over sorted, unique IDs
+ *  @param  ids  list of integer IDs
+ *  @param  epsilon  largest error, in positions, allowed for any model
+ *  @complexity O(n) (worst-case)
+ */
+LearnedIndex::LearnedIndex(vector<int> ids, const size_t epsilon) : _ids(std::move(ids)), _epsilon(epsilon)
+{
+    vector<int> keys = _ids;
+    do
+    {
+        _levels.push_back(_fit(keys, _epsilon));
+        keys.clear();
+        for (const Segment& segment : _levels.back()) keys.push_back(segment.id);
+    } while (keys.size() > 1);
+}
+
+/**
+ *  @brief  Fit sorted IDs with the fewest segments a greedy shrinking cone finds within an error bound
+ *  @param  ids  list of integer IDs
+ *  @param  epsilon  largest error, in positions, allowed for any segment
+ *  @return list of segments, sorted by first ID
+ *  @complexity O(n) (worst-case)
+ */
+vector<LearnedIndex::Segment> LearnedIndex::_fit(const vector<int>& ids, const size_t epsilon)
+{
+    vector<Segment> segments;
+    size_t first = 0;
+    while (first < ids.size())
+    {
+        // narrow the range of slopes that keep every ID so far within epsilon of its position
+        double lowest = 0, highest = std::numeric_limits<double>::infinity();
+        size_t next = first + 1;
+        for (; next < ids.size(); next++)
+        {
+            const double run = static_cast<double>(ids[next]) - static_cast<double>(ids[first]);
+            const double rise = static_cast<double>(next - first);
+            const double slope_low = (rise - static_cast<double>(epsilon)) / run;
+            const double slope_high = (rise + static_cast<double>(epsilon)) / run;
+            if (max(lowest, slope_low) > min(highest, slope_high)) break;
+            lowest = max(lowest, slope_low);
+            highest = min(highest, slope_high);
+        }
+        const double slope = (next == first + 1) ? 0 : (lowest + highest) / 2;
+        segments.push_back({ids[first], first, slope});
+        first = next;
+    }
+    return segments;
+}
+
+/**
+ *  @brief  Predict the position of an ID with a segment, clamped to the positions the segment covers
+ *  @param  segments  list of segments of a level
+ *  @param  index  index of the segment
+ *  @param  id  integer ID
+ *  @param  count  number of keys modeled by the level
+ *  @return predicted position
+ */
+size_t LearnedIndex::_predict(const vector<Segment>& segments, const size_t index, const int id, const size_t count)
+{
+    const Segment& segment = segments[index];
+    const size_t end = (index + 1 < segments.size()) ? segments[index + 1].position : count;
+    const double offset = segment.slope * (static_cast<double>(id) - static_cast<double>(segment.id));
+    return min(segment.position + static_cast<size_t>(max(0.0, offset)), end);
+}
+
+/**
+ *  @brief  Find, by model prediction and a bounded search, the position of an ID
+ *  @param  id  integer ID
+ *  @return position of the ID among the sorted IDs; -1 if not found
+ *  @complexity O(log(levels) + levels * log(epsilon)) (worst-case)
+ */
+long LearnedIndex::find(const int id) const
+{
+    if (_ids.empty() || id < _ids.front()) return -1;
+
+    size_t index = 0;
+    for (size_t level = _levels.size(); level-- > 0;)
+    {
+        const vector<Segment>& segments = _levels[level];
+        const bool is_bottom = (level == 0);
+        const size_t count = is_bottom ? _ids.size() : _levels[level - 1].size();
+        const size_t predicted = _predict(segments, index, id, count);
+        const size_t first = (predicted > _epsilon + 1) ? predicted - _epsilon - 1 : 0;
+        const size_t last = min(predicted + _epsilon + 2, count);
+
+        if (is_bottom)
+        {
+            const auto match = std::lower_bound(_ids.begin() + first, _ids.begin() + last, id);
+            return (match != _ids.begin() + last && *match == id) ? match - _ids.begin() : -1;
+        }
+
+        const vector<Segment>& below = _levels[level - 1];
+        const auto next = std::upper_bound(below.begin() + first, below.begin() + last, id,
+                                           [](const int key, const Segment& segment) { return key < segment.id; });
+        index = static_cast<size_t>(next - below.begin()) - 1;
+    }
+    return -1;
+}
+
+/**
+ *  @brief  Check whether an ID is indexed
+ *  @param  id  integer ID
+ *  @return boolean indicating whether the ID is found
+ */
+bool LearnedIndex::contains(const int id) const
+{
+    return find(id) >= 0;
+}
+
+/**
+ *  @brief  Get the number of segments in all levels of @c this index
+ *  @return number of segments
+ */
+size_t LearnedIndex::segmentCount() const
+{
+    size_t count = 0;
+    for (const vector<Segment>& segments : _levels) count += segments.size();
+    return count;
+}
+
+#endif //LEARNEDINDEX_H
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <functional>
 using std::vector;
 using std::string;
 
@@ -20,4 +22,49 @@ public:
             id(i), name(std::move(s)), height(0), left(nullptr), right(nullptr) {}
 };
 
+/// Object class for a contiguous, cache-line aligned block of memory for @c Nodes constructed in place
+class NodeArena {
+
+private:
+    void* _block;
+    static const size_t CACHE_LINE = 64;
+
+public:
+    Node* const nodes;
+    const size_t capacity;
+    explicit NodeArena(size_t count);
+    ~NodeArena();
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+    bool contains(const Node* node) const;
+};
+
+/**
+ *  @brief  Allocate, without constructing, memory for a number of @c Nodes
+ *  @param  count  number of @c Nodes
+ */
+NodeArena::NodeArena(const size_t count) :
+        _block(::operator new(count * sizeof(Node) + CACHE_LINE)),
+        nodes(reinterpret_cast<Node*>((reinterpret_cast<uintptr_t>(_block) + CACHE_LINE - 1) & ~(CACHE_LINE - 1))),
+        capacity(count) {}
+
+/**
+ *  @brief  Free the memory of @c this arena; the @c Nodes within must already be destroyed
+ */
+NodeArena::~NodeArena()
+{
+    ::operator delete(_block);
+}
+
+/**
+ *  @brief  Check whether a @c Node lies within @c this arena
+ *  @param  node  pointer to the @c Node
+ *  @return boolean indicating whether the @c Node lies within @c this arena
+ */
+bool NodeArena::contains(const Node* node) const
+{
+    std::less<const Node*> precedes;
+    return !precedes(node, nodes) && precedes(node, nodes + capacity);
+}
+
 #endif //NODE_H
\ No newline at end of file
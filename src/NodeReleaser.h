@@ -0,0 +1,176 @@
+#ifndef NODERELEASER_H
+#define NODERELEASER_H
+
+#include "Node.h"
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+using std::deque;
+using std::shared_ptr;
+using std::thread;
+using std::mutex;
+using std::unique_lock;
+using std::condition_variable;
+using std::atomic;
+
+/// Object class for the background thread that frees the @c Nodes of large trees being cleared or destroyed,
+/// so that their owners return without walking them
+class NodeReleaser {
+
+private:
+    /// Tree unlinked from its owner, with the arenas that may hold its @c Nodes
+    struct Job {
+        Node* root;
+        vector<shared_ptr<NodeArena>> arenas;
+    };
+
+    thread _worker;
+    mutex _mutex; // guards the jobs and the state of the worker
+    condition_variable _changed;
+    deque<Job> _jobs;
+    bool _is_busy = false;
+    bool _is_stopping = false;
+    static atomic<bool> _isShutDown; // set once the instance is destroyed, at exit; later releases run inline
+    NodeReleaser();
+    static NodeReleaser& _instance();
+    void _work();
+
+public:
+    ~NodeReleaser();
+    NodeReleaser(const NodeReleaser&) = delete;
+    NodeReleaser& operator=(const NodeReleaser&) = delete;
+    static void releaseNode(Node* node, const vector<shared_ptr<NodeArena>>& arenas);
+    static size_t releaseSubtree(Node* root, const vector<shared_ptr<NodeArena>>& arenas);
+    static void release(Node* root, vector<shared_ptr<NodeArena>> arenas);
+    static void wait();
+};
+
+atomic<bool> NodeReleaser::_isShutDown{false};
+
+/**
+ *  @brief  Start the background thread
+ */
+NodeReleaser::NodeReleaser()
+{
+    _worker = thread([this]() { _work(); }); // started once every other member is constructed
+}
+
+/**
+ *  @brief  Free the trees still queued, then stop and join the background thread
+ */
+NodeReleaser::~NodeReleaser()
+{
+    {
+        unique_lock<mutex> lock(_mutex);
+        _is_stopping = true;
+    }
+    _changed.notify_all();
+    _worker.join();
+    _isShutDown = true;
+}
+
+/**
+ *  @brief  Get the releaser shared by every tree, starting it on first use
+ *  @return releaser
+ */
+NodeReleaser& NodeReleaser::_instance()
+{
+    static NodeReleaser releaser;
+    return releaser;
+}
+
+/**
+ *  @brief  Free the queued trees, oldest first, until stopped with none left
+ */
+void NodeReleaser::_work()
+{
+    unique_lock<mutex> lock(_mutex);
+    while (true)
+    {
+        _changed.wait(lock, [this]() { return _is_stopping || !_jobs.empty(); });
+        if (_jobs.empty()) return;
+
+        Job job = std::move(_jobs.front());
+        _jobs.pop_front();
+        _is_busy = true;
+        lock.unlock();
+        releaseSubtree(job.root, job.arenas);
+        job.arenas.clear(); // an arena is freed once no tree shares it
+        lock.lock();
+        _is_busy = false;
+        _changed.notify_all();
+    }
+}
+
+/**
+ *  @brief  Free the memory of a @c Node unlinked from any tree
+ *  @param  node  pointer to the @c Node
+ *  @param  arenas  arenas that may hold the @c Node; a @c Node in none was allocated individually
+ */
+void NodeReleaser::releaseNode(Node* node, const vector<shared_ptr<NodeArena>>& arenas)
+{
+    for (const shared_ptr<NodeArena>& arena : arenas)
+    {
+        if (!arena->contains(node)) continue;
+        node->~Node(); // the slot is freed with the arena
+        return;
+    }
+    delete node;
+}
+
+/**
+ *  @brief  Free, on the calling thread, every @c Node of a tree unlinked from any owner
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  arenas  arenas that may hold its @c Nodes
+ *  @return number of freed @c Nodes
+ *  @complexity O(n) (worst-case)
+ */
+size_t NodeReleaser::releaseSubtree(Node* root, const vector<shared_ptr<NodeArena>>& arenas)
+{
+    if (!root) return 0;
+
+    const size_t count = releaseSubtree(root->left, arenas) + releaseSubtree(root->right, arenas) + 1;
+    releaseNode(root, arenas);
+    return count;
+}
+
+/**
+ *  @brief  Queue a tree unlinked from any owner to be freed on the background thread
+ *  @param  root  pointer to the root @c Node of the tree
+ *  @param  arenas  arenas that may hold its @c Nodes, kept alive until they are freed
+ *  @note   at exit, once the background thread is joined, the tree is freed on the calling thread instead
+ *  @complexity O(1) (worst-case)
+ */
+void NodeReleaser::release(Node* root, vector<shared_ptr<NodeArena>> arenas)
+{
+    if (!root) return;
+    if (_isShutDown)
+    {
+        releaseSubtree(root, arenas);
+        return;
+    }
+
+    NodeReleaser& releaser = _instance();
+    {
+        unique_lock<mutex> lock(releaser._mutex);
+        releaser._jobs.push_back({root, std::move(arenas)});
+    }
+    releaser._changed.notify_all();
+}
+
+/**
+ *  @brief  Wait until every queued tree has been freed
+ */
+void NodeReleaser::wait()
+{
+    if (_isShutDown) return;
+
+    NodeReleaser& releaser = _instance();
+    unique_lock<mutex> lock(releaser._mutex);
+    releaser._changed.wait(lock, [&releaser]() { return releaser._jobs.empty() && !releaser._is_busy; });
+}
+
+#endif //NODERELEASER_H
@@ -0,0 +1,1069 @@
+#ifndef OPTIMISTICAVLTREE_H
+#define OPTIMISTICAVLTREE_H
+
+#include "AVLTree.h"
+#include "EpochManager.h"
+#include "CacheLineArray.h"
+#include <string>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+using std::string;
+using std::vector;
+using std::atomic;
+using std::mutex;
+using std::lock_guard;
+using std::max;
+
+/// Object class for a node of an optimistic concurrent tree, guarded by its own lock and version
+class OptimisticNode {
+
+public:
+    static const uint64_t UNLINKED = 1; // the whole version of a Node removed from the tree
+    static const uint64_t SHRINKING = 2; // set while a rotation moves the Node down
+    static const uint64_t SHRINK_COUNT = 4; // added by every completed rotation that moved the Node down
+    const int id;
+    atomic<int> height; // 1 for a leaf, 0 for an empty subtree
+    atomic<uint64_t> version;
+    atomic<string*> name; // nullptr marks a routing Node, whose ID was removed while it had two children
+    atomic<OptimisticNode*> parent;
+    atomic<OptimisticNode*> left;
+    atomic<OptimisticNode*> right;
+    mutex lock;
+
+    OptimisticNode(int i, int h, string* s, OptimisticNode* p) :
+            id(i), height(h), version(0), name(s), parent(p), left(nullptr), right(nullptr) {}
+    atomic<OptimisticNode*>& child(const bool is_right) { return is_right ? right : left; }
+};
+
+/// Object class for a concurrent self-balancing tree whose readers validate versions instead of locking and whose
+/// writers lock only the nodes they change (after Bronson, Casper, Chafi and Olukotun, PPoPP 2010)
+class OptimisticAVLTree {
+
+private:
+    /// Counts kept by the threads assigned to the stripe, a cache line each so that updates do not contend; an
+    /// update begins and ends on one thread, so its stripe's counts are equal while none of its updates is running
+    struct alignas(64) Stripe {
+        atomic<uint64_t> started{0}; // updates begun, including those that backed off
+        atomic<uint64_t> finished{0}; // updates completed or backed off
+        atomic<size_t> size{0}; // IDs inserted less IDs removed, modulo 2^64; only the sum over stripes is a size
+    };
+
+    OptimisticNode _rootHolder; // sentinel whose right child is the root
+    EpochManager _epochs; // frees unlinked Nodes and replaced names once no reader can hold them
+    CacheLineArray<Stripe> _stripes{STRIPE_COUNT};
+    atomic<bool> _isExclusive; // set while a traversal or removeInorder holds new updates back
+    mutex _exclusiveLock; // held for as long as updates are held back, by one caller at a time
+    static const size_t STRIPE_COUNT = 64; // threads beyond this many share stripes
+    static const int TRAVERSAL_ATTEMPTS = 8; // validated traversals tried before holding updates back
+    static const int RETRY = -1;
+    static const int UNLINK_REQUIRED = -1;
+    static const int REBALANCE_REQUIRED = -2;
+    static const int NOTHING_REQUIRED = -3;
+    static int _getHeight(OptimisticNode* node);
+    static bool _isShrinkingOrUnlinked(uint64_t version);
+    static void _waitUntilChanged(OptimisticNode* node, uint64_t version);
+    void _retire(OptimisticNode* node, string* name);
+    int _attemptGet(int id, OptimisticNode* node, bool is_right, uint64_t version, string& match);
+    int _attemptUpdate(int id, const string* name, OptimisticNode* parent, OptimisticNode* node, uint64_t version);
+    int _attemptNodeUpdate(const string* name, OptimisticNode* parent, OptimisticNode* node);
+    bool _attemptUnlink(OptimisticNode* parent, OptimisticNode* node);
+    static int _nodeCondition(OptimisticNode* node);
+    void _fixHeightAndRebalance(OptimisticNode* node);
+    static OptimisticNode* _fixHeight(OptimisticNode* node);
+    OptimisticNode* _rebalance(OptimisticNode* parent, OptimisticNode* node);
+    OptimisticNode* _rebalanceToRight(OptimisticNode* parent, OptimisticNode* node, OptimisticNode* left,
+                                      int right_height);
+    OptimisticNode* _rebalanceToLeft(OptimisticNode* parent, OptimisticNode* node, OptimisticNode* right,
+                                     int left_height);
+    static OptimisticNode* _rotateRight(OptimisticNode* parent, OptimisticNode* node, OptimisticNode* left,
+                                        int right_height, int left_left_height, OptimisticNode* left_right,
+                                        int left_right_height);
+    static OptimisticNode* _rotateLeft(OptimisticNode* parent, OptimisticNode* node, int left_height,
+                                       OptimisticNode* right, OptimisticNode* right_left, int right_left_height,
+                                       int right_right_height);
+    static OptimisticNode* _rotateRightOverLeft(OptimisticNode* parent, OptimisticNode* node, OptimisticNode* left,
+                                                int right_height, int left_left_height, OptimisticNode* left_right,
+                                                int left_right_left_height);
+    static OptimisticNode* _rotateLeftOverRight(OptimisticNode* parent, OptimisticNode* node, int left_height,
+                                                OptimisticNode* right, OptimisticNode* right_left,
+                                                int right_right_height, int right_left_right_height);
+    bool _remove(int id);
+    void _changeSize(size_t delta);
+    uint64_t _startedCount() const;
+    uint64_t _finishedCount() const;
+    void _beginUpdate();
+    void _endUpdate();
+    void _excludeUpdates();
+    void _admitUpdates();
+    static OptimisticNode* _selectInorder(OptimisticNode* root, int& count);
+    static void _copyDepthFirst(OptimisticNode* root, AVLTree::Traversal type, string& names);
+    static void _copyLevelorder(OptimisticNode* root, string& names);
+    static void _destroy(OptimisticNode* root);
+
+    /// Registration of an update for its scope, so that traversals can tell whether it overlapped them
+    class Update {
+
+    private:
+        OptimisticAVLTree& _tree;
+
+    public:
+        explicit Update(OptimisticAVLTree& tree) : _tree(tree) { _tree._beginUpdate(); }
+        ~Update() { _tree._endUpdate(); }
+        Update(const Update&) = delete;
+        Update& operator=(const Update&) = delete;
+    };
+
+public:
+    OptimisticAVLTree();
+    ~OptimisticAVLTree();
+    OptimisticAVLTree(const OptimisticAVLTree&) = delete;
+    OptimisticAVLTree& operator=(const OptimisticAVLTree&) = delete;
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    bool removeInorder(int count);
+    string search(int id);
+    string traversalToString(AVLTree::Traversal type = AVLTree::INORDER);
+    int levelCount();
+    size_t size() const;
+    size_t retiredCount();
+    uint64_t reclamationLag();
+};
+
+/**
+ *  @brief  Create an empty tree
+ */
+OptimisticAVLTree::OptimisticAVLTree() :
+        _rootHolder(0, 1, nullptr, nullptr), _isExclusive(false) {}
+
+/**
+ *  @brief  Free every @c OptimisticNode and name of @c this tree; those retired are freed with the epoch manager.
+ *          No operation may be in progress
+ */
+OptimisticAVLTree::~OptimisticAVLTree()
+{
+    _destroy(_rootHolder.right);
+}
+
+/**
+ *  @brief  Get the height of a subtree
+ *  @param  node  pointer to the root @c OptimisticNode of the subtree
+ *  @return height of the subtree; 0 if empty
+ */
+int OptimisticAVLTree::_getHeight(OptimisticNode* node)
+{
+    return node ? node->height.load() : 0;
+}
+
+/**
+ *  @brief  Check whether a version shows its @c OptimisticNode mid-rotation or removed
+ *  @param  version  version of an @c OptimisticNode
+ *  @return boolean indicating whether searches through the @c OptimisticNode must wait or retry
+ */
+bool OptimisticAVLTree::_isShrinkingOrUnlinked(const uint64_t version)
+{
+    return (version & (OptimisticNode::SHRINKING | OptimisticNode::UNLINKED)) != 0;
+}
+
+/**
+ *  @brief  Wait for a rotation that was moving an @c OptimisticNode down to complete
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @param  version  version read from the @c OptimisticNode
+ */
+void OptimisticAVLTree::_waitUntilChanged(OptimisticNode* node, const uint64_t version)
+{
+    if (!(version & OptimisticNode::SHRINKING)) return;
+
+    for (int spin = 0; spin < 100; spin++) if (node->version.load() != version) return;
+    lock_guard<mutex> lock(node->lock); // the rotating thread holds the lock until the rotation completes
+}
+
+/**
+ *  @brief  Hand an unlinked @c OptimisticNode or replaced name to the epoch manager, to be freed once no reader
+ *          can hold it
+ *  @param  node  pointer to the @c OptimisticNode; @c nullptr for none
+ *  @param  name  pointer to the name; @c nullptr for none
+ */
+void OptimisticAVLTree::_retire(OptimisticNode* node, string* name)
+{
+    if (node) _epochs.retire(node);
+    if (name) _epochs.retire(name);
+}
+
+/**
+ *  @brief  Search below an @c OptimisticNode, validating hand over hand that the @c OptimisticNode has not been
+ *          rotated down since it was reached
+ *  @param  id  integer ID
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @param  is_right  whether the ID lies to the right of the @c OptimisticNode
+ *  @param  version  version of the @c OptimisticNode when it was reached
+ *  @param  match  string to which the name of the found ID is copied
+ *  @return @c RETRY if the search must restart from the parent; 0 otherwise
+ */
+int OptimisticAVLTree::_attemptGet(const int id, OptimisticNode* node, const bool is_right, const uint64_t version,
+                                   string& match)
+{
+    while (true)
+    {
+        OptimisticNode* child = node->child(is_right).load();
+        if (!child) return (node->version.load() != version) ? RETRY : 0;
+
+        if (id == child->id)
+        {
+            string* name = child->name.load();
+            if (name) match = *name;
+            return 0;
+        }
+        const uint64_t child_version = child->version.load();
+        if (_isShrinkingOrUnlinked(child_version))
+        {
+            _waitUntilChanged(child, child_version);
+            if (node->version.load() != version) return RETRY;
+        }
+        else
+        if (child != node->child(is_right).load())
+        {
+            if (node->version.load() != version) return RETRY;
+        }
+        else
+        {
+            if (node->version.load() != version) return RETRY;
+            if (_attemptGet(id, child, id > child->id, child_version, match) != RETRY) return 0;
+        }
+    }
+}
+
+/**
+ *  @brief  Insert or remove an ID below an @c OptimisticNode, validating hand over hand as searches do
+ *  @param  id  integer ID
+ *  @param  name  full name to insert; @c nullptr to remove the ID
+ *  @param  parent  pointer to the parent of the @c OptimisticNode
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @param  version  version of the @c OptimisticNode when it was reached
+ *  @return @c RETRY if the update must restart from the parent; otherwise 1 if it changed the tree, 0 if not
+ */
+int OptimisticAVLTree::_attemptUpdate(const int id, const string* name, OptimisticNode* parent, OptimisticNode* node,
+                                      const uint64_t version)
+{
+    if (id == node->id) return _attemptNodeUpdate(name, parent, node);
+
+    const bool is_right = id > node->id;
+    while (true)
+    {
+        OptimisticNode* child = node->child(is_right).load();
+        if (node->version.load() != version) return RETRY;
+
+        if (!child)
+        {
+            if (!name) return 0; // the ID is absent
+
+            OptimisticNode* damaged = nullptr;
+            {
+                lock_guard<mutex> lock(node->lock);
+                if (node->version.load() != version) return RETRY;
+                if (node->child(is_right).load()) continue; // lost a race with another insertion here
+
+                node->child(is_right).store(new OptimisticNode(id, 1, new string(*name), node));
+                damaged = _fixHeight(node);
+            }
+            _changeSize(1);
+            _fixHeightAndRebalance(damaged);
+            return 1;
+        }
+
+        const uint64_t child_version = child->version.load();
+        if (_isShrinkingOrUnlinked(child_version)) _waitUntilChanged(child, child_version); else
+        if (child == node->child(is_right).load())
+        {
+            if (node->version.load() != version) return RETRY;
+            const int result = _attemptUpdate(id, name, node, child, child_version);
+            if (result != RETRY) return result;
+        }
+    }
+}
+
+/**
+ *  @brief  Insert or remove the ID of an @c OptimisticNode that was found
+ *  @param  name  full name to insert; @c nullptr to remove the ID
+ *  @param  parent  pointer to the parent of the @c OptimisticNode, locked only to unlink the @c OptimisticNode
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @return @c RETRY if the update must restart from the parent; otherwise 1 if it changed the tree, 0 if not
+ *  @note   an @c OptimisticNode with two children is not unlinked but left as a routing @c OptimisticNode without
+ *          a name, which rebalancing unlinks once it has fewer children
+ */
+int OptimisticAVLTree::_attemptNodeUpdate(const string* name, OptimisticNode* parent, OptimisticNode* node)
+{
+    if (!name && !node->name.load()) return 0;
+
+    if (!name && (!node->left.load() || !node->right.load()))
+    {
+        OptimisticNode* damaged = nullptr;
+        string* removal = nullptr;
+        {
+            lock_guard<mutex> parent_lock(parent->lock);
+            if (parent->version.load() == OptimisticNode::UNLINKED || node->parent.load() != parent) return RETRY;
+            {
+                lock_guard<mutex> node_lock(node->lock);
+                removal = node->name.load();
+                if (!removal) return 0;
+                if (!_attemptUnlink(parent, node)) return RETRY;
+            }
+            damaged = _fixHeight(parent);
+        }
+        _changeSize(-1);
+        _retire(node, removal);
+        _fixHeightAndRebalance(damaged);
+        return 1;
+    }
+
+    lock_guard<mutex> lock(node->lock);
+    if (node->version.load() == OptimisticNode::UNLINKED) return RETRY;
+
+    string* previous = node->name.load();
+    if (name)
+    {
+        if (previous) return 0; // the ID is present
+        node->name.store(new string(*name)); // revive a routing Node
+        _changeSize(1);
+        return 1;
+    }
+    if (!previous) return 0;
+    if (!node->left.load() || !node->right.load()) return RETRY; // the Node can now be unlinked instead
+    node->name.store(nullptr);
+    _changeSize(-1);
+    _retire(nullptr, previous);
+    return 1;
+}
+
+/**
+ *  @brief  Splice out an @c OptimisticNode with at most one child; both it and its parent are locked
+ *  @param  parent  pointer to the parent
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @return boolean indicating whether the @c OptimisticNode was unlinked; @c false if it is no longer a child
+ *          of the parent or has gained a second child
+ */
+bool OptimisticAVLTree::_attemptUnlink(OptimisticNode* parent, OptimisticNode* node)
+{
+    OptimisticNode* parent_left = parent->left.load();
+    if (parent_left != node && parent->right.load() != node) return false;
+
+    OptimisticNode* left = node->left.load();
+    OptimisticNode* right = node->right.load();
+    if (left && right) return false;
+
+    OptimisticNode* splice = left ? left : right;
+    if (parent_left == node) parent->left.store(splice); else parent->right.store(splice);
+    if (splice) splice->parent.store(parent);
+
+    node->version.store(OptimisticNode::UNLINKED);
+    node->name.store(nullptr);
+    return true;
+}
+
+/**
+ *  @brief  Determine the repair an @c OptimisticNode needs, from an unlocked read of it and its children
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @return @c UNLINK_REQUIRED, @c REBALANCE_REQUIRED, @c NOTHING_REQUIRED, or the corrected height
+ *  @note   a thread that changes an @c OptimisticNode takes responsibility for repairing it, so a read that is
+ *          not consistent never leaves damage unrepaired
+ */
+int OptimisticAVLTree::_nodeCondition(OptimisticNode* node)
+{
+    OptimisticNode* left = node->left.load();
+    OptimisticNode* right = node->right.load();
+    if ((!left || !right) && !node->name.load()) return UNLINK_REQUIRED;
+
+    const int height = node->height.load();
+    const int left_height = _getHeight(left);
+    const int right_height = _getHeight(right);
+    const int balance = left_height - right_height;
+    if (balance < -1 || balance > 1) return REBALANCE_REQUIRED;
+
+    const int repaired_height = 1 + max(left_height, right_height);
+    return (height != repaired_height) ? repaired_height : NOTHING_REQUIRED;
+}
+
+/**
+ *  @brief  Repair heights, balance and routing @c OptimisticNodes from a damaged @c OptimisticNode up to the root
+ *  @param  node  pointer to the lowest damaged @c OptimisticNode; @c nullptr for none
+ */
+void OptimisticAVLTree::_fixHeightAndRebalance(OptimisticNode* node)
+{
+    while (node && node->parent.load())
+    {
+        const int condition = _nodeCondition(node);
+        if (condition == NOTHING_REQUIRED || node->version.load() == OptimisticNode::UNLINKED) return;
+
+        if (condition != UNLINK_REQUIRED && condition != REBALANCE_REQUIRED)
+        {
+            lock_guard<mutex> lock(node->lock);
+            node = _fixHeight(node);
+            continue;
+        }
+
+        OptimisticNode* parent = node->parent.load();
+        lock_guard<mutex> parent_lock(parent->lock);
+        if (parent->version.load() != OptimisticNode::UNLINKED && node->parent.load() == parent)
+        {
+            lock_guard<mutex> node_lock(node->lock);
+            node = _rebalance(parent, node);
+        }
+    }
+}
+
+/**
+ *  @brief  Correct the height of a locked @c OptimisticNode, if that is all it needs
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_fixHeight(OptimisticNode* node)
+{
+    const int condition = _nodeCondition(node);
+    if (condition == REBALANCE_REQUIRED || condition == UNLINK_REQUIRED) return node;
+    if (condition == NOTHING_REQUIRED) return nullptr;
+
+    node->height.store(condition);
+    return node->parent.load(); // whose height may now be stale
+}
+
+/**
+ *  @brief  Unlink, rotate or correct the height of a locked @c OptimisticNode under its locked parent
+ *  @param  parent  pointer to the parent
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rebalance(OptimisticNode* parent, OptimisticNode* node)
+{
+    OptimisticNode* left = node->left.load();
+    OptimisticNode* right = node->right.load();
+    if ((!left || !right) && !node->name.load())
+    {
+        if (!_attemptUnlink(parent, node)) return node;
+        _retire(node, nullptr);
+        return _fixHeight(parent);
+    }
+
+    const int height = node->height.load();
+    const int left_height = _getHeight(left);
+    const int right_height = _getHeight(right);
+    const int balance = left_height - right_height;
+    if (balance > 1) return _rebalanceToRight(parent, node, left, right_height);
+    if (balance < -1) return _rebalanceToLeft(parent, node, right, left_height);
+
+    const int repaired_height = 1 + max(left_height, right_height);
+    if (height == repaired_height) return nullptr;
+    node->height.store(repaired_height);
+    return _fixHeight(parent);
+}
+
+/**
+ *  @brief  Rotate a locked @c OptimisticNode whose left subtree is too tall clockwise, first rotating the left
+ *          child counterclockwise if its right subtree is the taller
+ *  @param  parent  pointer to the locked parent
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @param  left  pointer to the left child
+ *  @param  right_height  height of the right subtree
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rebalanceToRight(OptimisticNode* parent, OptimisticNode* node,
+                                                     OptimisticNode* left, const int right_height)
+{
+    lock_guard<mutex> left_lock(left->lock);
+    if (left->height.load() - right_height <= 1) return node; // changed since read; retry
+
+    OptimisticNode* left_right = left->right.load();
+    const int left_left_height = _getHeight(left->left.load());
+    const int left_right_height = _getHeight(left_right);
+    if (left_left_height >= left_right_height)
+        return _rotateRight(parent, node, left, right_height, left_left_height, left_right, left_right_height);
+
+    {
+        lock_guard<mutex> left_right_lock(left_right->lock);
+        const int locked_left_right_height = left_right->height.load();
+        if (left_left_height >= locked_left_right_height)
+            return _rotateRight(parent, node, left, right_height, left_left_height, left_right,
+                                locked_left_right_height);
+
+        const int left_right_left_height = _getHeight(left_right->left.load());
+        const int balance = left_left_height - left_right_left_height;
+        if (balance >= -1 && balance <= 1)
+            return _rotateRightOverLeft(parent, node, left, right_height, left_left_height, left_right,
+                                        left_right_left_height);
+    }
+    // a double rotation would leave the left child unbalanced, so rotate only it and repair the rest later
+    return _rebalanceToLeft(node, left, left_right, left_left_height);
+}
+
+/**
+ *  @brief  Rotate a locked @c OptimisticNode whose right subtree is too tall counterclockwise, first rotating the
+ *          right child clockwise if its left subtree is the taller
+ *  @param  parent  pointer to the locked parent
+ *  @param  node  pointer to the @c OptimisticNode
+ *  @param  right  pointer to the right child
+ *  @param  left_height  height of the left subtree
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rebalanceToLeft(OptimisticNode* parent, OptimisticNode* node,
+                                                    OptimisticNode* right, const int left_height)
+{
+    lock_guard<mutex> right_lock(right->lock);
+    if (left_height - right->height.load() >= -1) return node; // changed since read; retry
+
+    OptimisticNode* right_left = right->left.load();
+    const int right_left_height = _getHeight(right_left);
+    const int right_right_height = _getHeight(right->right.load());
+    if (right_right_height >= right_left_height)
+        return _rotateLeft(parent, node, left_height, right, right_left, right_left_height, right_right_height);
+
+    {
+        lock_guard<mutex> right_left_lock(right_left->lock);
+        const int locked_right_left_height = right_left->height.load();
+        if (right_right_height >= locked_right_left_height)
+            return _rotateLeft(parent, node, left_height, right, right_left, locked_right_left_height,
+                               right_right_height);
+
+        const int right_left_right_height = _getHeight(right_left->right.load());
+        const int balance = right_right_height - right_left_right_height;
+        if (balance >= -1 && balance <= 1)
+            return _rotateLeftOverRight(parent, node, left_height, right, right_left, right_right_height,
+                                        right_left_right_height);
+    }
+    return _rebalanceToRight(node, right, right_left, right_right_height);
+}
+
+/**
+ *  @brief  Rotate a locked @c OptimisticNode clockwise, marking it as shrinking so that searches through it retry
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rotateRight(OptimisticNode* parent, OptimisticNode* node, OptimisticNode* left,
+                                                const int right_height, const int left_left_height,
+                                                OptimisticNode* left_right, const int left_right_height)
+{
+    const uint64_t version = node->version.load();
+    OptimisticNode* parent_left = parent->left.load();
+    node->version.store(version | OptimisticNode::SHRINKING);
+
+    // links into the shrinking Node change last, so that a search cannot bypass its version
+    node->left.store(left_right);
+    left->right.store(node);
+    if (parent_left == node) parent->left.store(left); else parent->right.store(left);
+    left->parent.store(parent);
+    node->parent.store(left);
+    if (left_right) left_right->parent.store(node);
+
+    const int node_height = 1 + max(left_right_height, right_height);
+    node->height.store(node_height);
+    left->height.store(1 + max(left_left_height, node_height));
+    node->version.store(version + OptimisticNode::SHRINK_COUNT);
+
+    const int node_balance = left_right_height - right_height;
+    if (node_balance < -1 || node_balance > 1) return node;
+    if ((!left_right || !right_height) && !node->name.load()) return node;
+    const int left_balance = left_left_height - node_height;
+    if (left_balance < -1 || left_balance > 1) return left;
+    if (!left_left_height && !left->name.load()) return left;
+    return _fixHeight(parent);
+}
+
+/**
+ *  @brief  Rotate a locked @c OptimisticNode counterclockwise, marking it as shrinking so that searches through it
+ *          retry
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rotateLeft(OptimisticNode* parent, OptimisticNode* node, const int left_height,
+                                               OptimisticNode* right, OptimisticNode* right_left,
+                                               const int right_left_height, const int right_right_height)
+{
+    const uint64_t version = node->version.load();
+    OptimisticNode* parent_left = parent->left.load();
+    node->version.store(version | OptimisticNode::SHRINKING);
+
+    node->right.store(right_left);
+    right->left.store(node);
+    if (parent_left == node) parent->left.store(right); else parent->right.store(right);
+    right->parent.store(parent);
+    node->parent.store(right);
+    if (right_left) right_left->parent.store(node);
+
+    const int node_height = 1 + max(left_height, right_left_height);
+    node->height.store(node_height);
+    right->height.store(1 + max(node_height, right_right_height));
+    node->version.store(version + OptimisticNode::SHRINK_COUNT);
+
+    const int node_balance = right_left_height - left_height;
+    if (node_balance < -1 || node_balance > 1) return node;
+    if ((!right_left || !left_height) && !node->name.load()) return node;
+    const int right_balance = right_right_height - node_height;
+    if (right_balance < -1 || right_balance > 1) return right;
+    if (!right_right_height && !right->name.load()) return right;
+    return _fixHeight(parent);
+}
+
+/**
+ *  @brief  Rotate the left child of a locked @c OptimisticNode counterclockwise and then the @c OptimisticNode
+ *          clockwise, marking both as shrinking
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rotateRightOverLeft(OptimisticNode* parent, OptimisticNode* node,
+                                                        OptimisticNode* left, const int right_height,
+                                                        const int left_left_height, OptimisticNode* left_right,
+                                                        const int left_right_left_height)
+{
+    const uint64_t version = node->version.load();
+    const uint64_t left_version = left->version.load();
+    OptimisticNode* parent_left = parent->left.load();
+    OptimisticNode* left_right_left = left_right->left.load();
+    OptimisticNode* left_right_right = left_right->right.load();
+    const int left_right_right_height = _getHeight(left_right_right);
+
+    node->version.store(version | OptimisticNode::SHRINKING);
+    left->version.store(left_version | OptimisticNode::SHRINKING);
+
+    node->left.store(left_right_right);
+    left->right.store(left_right_left);
+    left_right->left.store(left);
+    left_right->right.store(node);
+    if (parent_left == node) parent->left.store(left_right); else parent->right.store(left_right);
+    left_right->parent.store(parent);
+    left->parent.store(left_right);
+    node->parent.store(left_right);
+    if (left_right_right) left_right_right->parent.store(node);
+    if (left_right_left) left_right_left->parent.store(left);
+
+    const int node_height = 1 + max(left_right_right_height, right_height);
+    node->height.store(node_height);
+    const int left_height = 1 + max(left_left_height, left_right_left_height);
+    left->height.store(left_height);
+    left_right->height.store(1 + max(left_height, node_height));
+
+    left->version.store(left_version + OptimisticNode::SHRINK_COUNT);
+    node->version.store(version + OptimisticNode::SHRINK_COUNT);
+
+    const int node_balance = left_right_right_height - right_height;
+    if (node_balance < -1 || node_balance > 1) return node;
+    if ((!left_right_right || !right_height) && !node->name.load()) return node;
+    const int balance = left_height - node_height;
+    if (balance < -1 || balance > 1) return left_right;
+    return _fixHeight(parent);
+}
+
+/**
+ *  @brief  Rotate the right child of a locked @c OptimisticNode clockwise and then the @c OptimisticNode
+ *          counterclockwise, marking both as shrinking
+ *  @return pointer to the lowest @c OptimisticNode still damaged; @c nullptr if none is
+ */
+OptimisticNode* OptimisticAVLTree::_rotateLeftOverRight(OptimisticNode* parent, OptimisticNode* node,
+                                                        const int left_height, OptimisticNode* right,
+                                                        OptimisticNode* right_left, const int right_right_height,
+                                                        const int right_left_right_height)
+{
+    const uint64_t version = node->version.load();
+    const uint64_t right_version = right->version.load();
+    OptimisticNode* parent_left = parent->left.load();
+    OptimisticNode* right_left_left = right_left->left.load();
+    OptimisticNode* right_left_right = right_left->right.load();
+    const int right_left_left_height = _getHeight(right_left_left);
+
+    node->version.store(version | OptimisticNode::SHRINKING);
+    right->version.store(right_version | OptimisticNode::SHRINKING);
+
+    node->right.store(right_left_left);
+    right->left.store(right_left_right);
+    right_left->left.store(node);
+    right_left->right.store(right);
+    if (parent_left == node) parent->left.store(right_left); else parent->right.store(right_left);
+    right_left->parent.store(parent);
+    node->parent.store(right_left);
+    right->parent.store(right_left);
+    if (right_left_left) right_left_left->parent.store(node);
+    if (right_left_right) right_left_right->parent.store(right);
+
+    const int node_height = 1 + max(left_height, right_left_left_height);
+    node->height.store(node_height);
+    const int right_height = 1 + max(right_left_right_height, right_right_height);
+    right->height.store(right_height);
+    right_left->height.store(1 + max(node_height, right_height));
+
+    right->version.store(right_version + OptimisticNode::SHRINK_COUNT);
+    node->version.store(version + OptimisticNode::SHRINK_COUNT);
+
+    const int node_balance = right_left_left_height - left_height;
+    if (node_balance < -1 || node_balance > 1) return node;
+    if ((!right_left_left || !left_height) && !node->name.load()) return node;
+    const int balance = right_height - node_height;
+    if (balance < -1 || balance > 1) return right_left;
+    return _fixHeight(parent);
+}
+
+/**
+ *  @brief  Count IDs inserted or removed by the calling thread in its stripe
+ *  @param  delta  1 for an inserted ID; -1, wrapping around, for a removed one
+ */
+void OptimisticAVLTree::_changeSize(const size_t delta)
+{
+    _stripes.local().size.fetch_add(delta, std::memory_order_relaxed);
+}
+
+/**
+ *  @brief  Sum the updates begun over every stripe
+ *  @return number of updates begun
+ *  @complexity O(STRIPE_COUNT)
+ */
+uint64_t OptimisticAVLTree::_startedCount() const
+{
+    uint64_t count = 0;
+    for (const Stripe& stripe : _stripes) count += stripe.started.load();
+    return count;
+}
+
+/**
+ *  @brief  Sum the updates completed or backed off over every stripe; read before @c _startedCount, an equal sum
+ *          means that no update was running in between, since no stripe's finished count passes its started count
+ *  @return number of updates completed or backed off
+ *  @complexity O(STRIPE_COUNT)
+ */
+uint64_t OptimisticAVLTree::_finishedCount() const
+{
+    uint64_t count = 0;
+    for (const Stripe& stripe : _stripes) count += stripe.finished.load();
+    return count;
+}
+
+/**
+ *  @brief  Register an update in the stripe of the calling thread, waiting first while updates are held back
+ */
+void OptimisticAVLTree::_beginUpdate()
+{
+    Stripe& stripe = _stripes.local();
+    while (true)
+    {
+        stripe.started++;
+        if (!_isExclusive.load()) return;
+
+        stripe.finished++; // backs off until the exclusive caller is done
+        while (_isExclusive.load()) std::this_thread::yield();
+    }
+}
+
+/**
+ *  @brief  Register the completion of an update in the stripe of the calling thread
+ */
+void OptimisticAVLTree::_endUpdate()
+{
+    _stripes.local().finished++;
+}
+
+/**
+ *  @brief  Hold new updates back and wait for those in progress to complete
+ *  @note   readers by ID carry on meanwhile
+ */
+void OptimisticAVLTree::_excludeUpdates()
+{
+    _exclusiveLock.lock();
+    _isExclusive.store(true);
+    while (true)
+    {
+        const uint64_t finished = _finishedCount(); // read first, so that equal counts mean none was running
+        if (_startedCount() == finished) return;
+        std::this_thread::yield();
+    }
+}
+
+/**
+ *  @brief  Let the updates held back by @c _excludeUpdates proceed
+ */
+void OptimisticAVLTree::_admitUpdates()
+{
+    _isExclusive.store(false);
+    _exclusiveLock.unlock();
+}
+
+/**
+ *  @brief  Find the named @c OptimisticNode at an inorder count, skipping routing @c OptimisticNodes
+ *  @param  root  pointer to the root @c OptimisticNode of a tree
+ *  @param  count  inorder count, decremented by every named @c OptimisticNode passed
+ *  @return pointer to the found @c OptimisticNode; @c nullptr if the tree holds no more IDs than the count
+ *  @complexity O(count + log n) (expected)
+ */
+OptimisticNode* OptimisticAVLTree::_selectInorder(OptimisticNode* root, int& count)
+{
+    if (!root) return nullptr;
+
+    OptimisticNode* found = _selectInorder(root->left.load(), count);
+    if (found) return found;
+    if (root->name.load() && count-- == 0) return root;
+    return _selectInorder(root->right.load(), count);
+}
+
+/**
+ *  @brief Copies a comma-separated inorder, preorder or postorder traversal of the named @c OptimisticNodes to a
+ *         string
+ *  @param root  pointer to the root @c OptimisticNode of a tree
+ *  @param type  type of tree traversal
+ *  @param names  string to which names list is copied
+ */
+void OptimisticAVLTree::_copyDepthFirst(OptimisticNode* root, const AVLTree::Traversal type, string& names)
+{
+    if (!root) return;
+
+    string* name = root->name.load();
+    if (name && type == AVLTree::PREORDER) names += (*name + ", ");
+    _copyDepthFirst(root->left.load(), type, names);
+    if (name && type == AVLTree::INORDER) names += (*name + ", ");
+    _copyDepthFirst(root->right.load(), type, names);
+    if (name && type == AVLTree::POSTORDER) names += (*name + ", ");
+}
+
+/**
+ *  @brief Copies a comma-separated levelorder traversal of the named @c OptimisticNodes to a string
+ *  @param root  pointer to the root @c OptimisticNode of a tree
+ *  @param names  string to which names list is copied
+ */
+void OptimisticAVLTree::_copyLevelorder(OptimisticNode* root, string& names)
+{
+    if (!root) return;
+
+    std::queue<OptimisticNode*> nodes_queue;
+    nodes_queue.push(root);
+    while (!nodes_queue.empty())
+    {
+        OptimisticNode* current = nodes_queue.front();
+        nodes_queue.pop();
+
+        string* name = current->name.load();
+        if (name) names += (*name + ", ");
+        OptimisticNode* left = current->left.load();
+        OptimisticNode* right = current->right.load();
+        if (left) nodes_queue.push(left);
+        if (right) nodes_queue.push(right);
+    }
+}
+
+/**
+ *  @brief  Free every @c OptimisticNode and name of a tree
+ *  @param  root  pointer to the root @c OptimisticNode of the tree
+ */
+void OptimisticAVLTree::_destroy(OptimisticNode* root)
+{
+    if (!root) return;
+
+    _destroy(root->left.load());
+    _destroy(root->right.load());
+    delete root->name.load();
+    delete root;
+}
+
+/**
+ *  @brief  Insert an ID and name to @c this tree, locking only the @c OptimisticNodes that change
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the ID was absent and is inserted
+ *  @complexity O(log n) (expected, without contention)
+ */
+bool OptimisticAVLTree::insert(const int id, const string& name)
+{
+    EpochManager::Guard guard(_epochs);
+    Update update(*this);
+    while (true)
+    {
+        OptimisticNode* root = _rootHolder.right.load();
+        if (!root)
+        {
+            lock_guard<mutex> lock(_rootHolder.lock);
+            if (_rootHolder.right.load()) continue;
+            _rootHolder.right.store(new OptimisticNode(id, 1, new string(name), &_rootHolder));
+            _rootHolder.height.store(2);
+            _changeSize(1);
+            return true;
+        }
+
+        const uint64_t version = root->version.load();
+        if (_isShrinkingOrUnlinked(version)) _waitUntilChanged(root, version); else
+        if (root == _rootHolder.right.load())
+        {
+            const int result = _attemptUpdate(id, &name, &_rootHolder, root, version);
+            if (result != RETRY) return result == 1;
+        }
+    }
+}
+
+/**
+ *  @brief  Identify, by ID, and remove an entry from @c this tree, locking only the @c OptimisticNodes that change
+ *  @param  id integer ID
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(log n) (expected, without contention)
+ */
+bool OptimisticAVLTree::remove(const int id)
+{
+    EpochManager::Guard guard(_epochs);
+    Update update(*this);
+    return _remove(id);
+}
+
+/**
+ *  @brief  Identify, by ID, and remove an entry from @c this tree, within an update registered by the caller
+ *  @param  id integer ID
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(log n) (expected, without contention)
+ */
+bool OptimisticAVLTree::_remove(const int id)
+{
+    while (true)
+    {
+        OptimisticNode* root = _rootHolder.right.load();
+        if (!root) return false;
+
+        const uint64_t version = root->version.load();
+        if (_isShrinkingOrUnlinked(version)) _waitUntilChanged(root, version); else
+        if (root == _rootHolder.right.load())
+        {
+            const int result = _attemptUpdate(id, nullptr, &_rootHolder, root, version);
+            if (result != RETRY) return result == 1;
+        }
+    }
+}
+
+/**
+ *  @brief  Identify, by inorder count, and remove an entry from @c this tree, holding updates back meanwhile
+ *  @param  count inorder count
+ *  @return boolean indicating whether an entry was removed
+ *  @note   searches by ID carry on meanwhile
+ *  @complexity O(count + log n) (expected)
+ */
+bool OptimisticAVLTree::removeInorder(int count)
+{
+    if (count < 0) return false;
+
+    EpochManager::Guard guard(_epochs);
+    _excludeUpdates();
+    OptimisticNode* node = _selectInorder(_rootHolder.right.load(), count);
+    bool is_removed = false;
+    if (node)
+    {
+        Stripe& stripe = _stripes.local();
+        stripe.started++; // invalidates the traversals that overlap the removal
+        is_removed = _remove(node->id);
+        stripe.finished++;
+    }
+    _admitUpdates();
+    return is_removed;
+}
+
+/**
+ *  @brief  Search for an ID from @c this tree without taking any lock; the epoch pin keeps every
+ *          @c OptimisticNode it may reach allocated
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @complexity O(log n) (expected, without contention)
+ */
+string OptimisticAVLTree::search(const int id)
+{
+    EpochManager::Guard guard(_epochs);
+    string match;
+    while (true)
+    {
+        OptimisticNode* root = _rootHolder.right.load();
+        if (!root) return match;
+        if (id == root->id)
+        {
+            string* name = root->name.load();
+            return name ? *name : match;
+        }
+
+        const uint64_t version = root->version.load();
+        if (_isShrinkingOrUnlinked(version)) _waitUntilChanged(root, version); else
+        if (root == _rootHolder.right.load() && _attemptGet(id, root, id > root->id, version, match) != RETRY)
+            return match;
+    }
+}
+
+/**
+ *  @brief  Get a comma-separated list of names from @c this tree, as of a moment when no update was in progress
+ *  @param  type type of tree traversal to generate the list from; the shape traversed is that of the relaxed
+ *          balance of @c this tree, and routing @c OptimisticNodes are skipped
+ *  @return comma-separated list of names as a string
+ *  @note   the copy is retried unless no update started or was running across it, and after
+ *          @c TRAVERSAL_ATTEMPTS failures is made with new updates held back; searches by ID never wait
+ *  @complexity O(n) (worst-case) per attempt
+ */
+string OptimisticAVLTree::traversalToString(const AVLTree::Traversal type)
+{
+    EpochManager::Guard guard(_epochs);
+    const auto copy = [this, type](string& names)
+    {
+        names.clear();
+        if (type == AVLTree::LEVELORDER) _copyLevelorder(_rootHolder.right.load(), names);
+        else _copyDepthFirst(_rootHolder.right.load(), type, names);
+    };
+    string names;
+    bool is_copied = false;
+    for (int attempt = 0; attempt < TRAVERSAL_ATTEMPTS && !is_copied; attempt++)
+    {
+        const uint64_t finished = _finishedCount();
+        const uint64_t started = _startedCount();
+        if (started != finished)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        copy(names);
+        is_copied = _startedCount() == started;
+    }
+    if (!is_copied)
+    {
+        _excludeUpdates();
+        copy(names);
+        _admitUpdates();
+    }
+    if (names.empty()) return names;
+
+    names.pop_back(); // removes the last space
+    names.pop_back(); // removes the last comma
+    return names;
+}
+
+/**
+ *  @brief  Get the number of levels of @c this tree, counting routing @c OptimisticNodes
+ *  @return highest level of @c this tree
+ */
+int OptimisticAVLTree::levelCount()
+{
+    return _getHeight(_rootHolder.right.load());
+}
+
+/**
+ *  @brief  Get the number of IDs in @c this tree, summed over the stripes
+ *  @return number of IDs; exact while no update is running
+ *  @complexity O(STRIPE_COUNT)
+ */
+size_t OptimisticAVLTree::size() const
+{
+    size_t count = 0;
+    for (const Stripe& stripe : _stripes) count += stripe.size.load(std::memory_order_relaxed);
+    return count;
+}
+
+/**
+ *  @brief  Get the number of @c OptimisticNodes and names unlinked but not yet freed, because readers may still
+ *          hold them
+ *  @return number of retired objects
+ */
+size_t OptimisticAVLTree::retiredCount()
+{
+    return _epochs.pendingCount();
+}
+
+/**
+ *  @brief  Get the number of epochs the oldest retired object has waited to be freed
+ *  @return epochs since the oldest retired object was retired; 0 if none is
+ */
+uint64_t OptimisticAVLTree::reclamationLag()
+{
+    return _epochs.reclamationLag();
+}
+
+#endif //OPTIMISTICAVLTREE_H
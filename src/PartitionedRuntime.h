@@ -0,0 +1,447 @@
+#ifndef PARTITIONEDRUNTIME_H
+#define PARTITIONEDRUNTIME_H
+
+#include "AVLTree.h"
+#include "helpers.h"
+#include "SpscQueue.h"
+#include <iostream>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+using std::istream;
+using std::ostream;
+using std::deque;
+using std::unique_ptr;
+using std::thread;
+
+/// Object class for a shared-nothing runtime: the ID space is divided into ranges, each owned by one @c AVLTree
+/// and one thread pinned to its own core, and commands are routed to their owners through lock-free queues
+class PartitionedRuntime {
+
+public:
+    static const int ID_LIMIT = 100000000; // the 8-digit ID space is divided evenly among the partitions
+    static const size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+private:
+    enum Kind { INSERT, REMOVE, REMOVE_INORDER, SEARCH_ID, SEARCH_NAME, TRAVERSE, LEVEL_COUNT, STOP, REPLY };
+
+    /// Command routed to a partition
+    struct Request {
+        Kind kind = STOP;
+        int id = 0; // ID, or inorder count within the partition
+        string name;
+        AVLTree::Traversal traversal = AVLTree::INORDER;
+    };
+
+    /// Result of a command from a partition
+    struct Response {
+        bool is_successful = false;
+        string text; // found name or traversal
+        vector<string> matches;
+        int level_count = 0;
+    };
+
+    /// Range of IDs owned by one thread, with the queues to and from the dispatching thread
+    struct Partition {
+        AVLTree tree; // touched by the owning thread only
+        SpscQueue<Request> requests;
+        SpscQueue<Response> responses;
+        thread worker;
+        size_t size = 0; // as known to the dispatching thread from the responses it has read
+        Response stash; // response read ahead by the dispatching thread
+        bool is_stashed = false;
+        explicit Partition(const size_t capacity) : requests(capacity), responses(capacity) {}
+    };
+
+    /// Command dispatched and not yet answered, in the order of the commands
+    struct Pending {
+        Kind kind;
+        size_t partition; // owner of a routed command; every partition answers a broadcast one
+        string reply; // fixed answer of a @c REPLY
+    };
+
+    vector<unique_ptr<Partition>> _partitions;
+    deque<Pending> _pending;
+    static const size_t ALL = static_cast<size_t>(-1);
+    static void _pin(thread& worker, unsigned core);
+    static void _work(Partition& partition);
+    static Response _apply(AVLTree& tree, const Request& request);
+    size_t _partitionOf(int id) const;
+    void _send(size_t partition, Request& request, ostream& output);
+    void _broadcast(const Request& request, ostream& output);
+    void _reply(const string& reply);
+    bool _isAnswered(size_t partition);
+    bool _complete(bool is_waiting, ostream& output);
+    void _dispatch(istream& input, ostream& output);
+
+public:
+    explicit PartitionedRuntime(unsigned partitions = std::max(1u, thread::hardware_concurrency()),
+                                size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+    ~PartitionedRuntime();
+    PartitionedRuntime(const PartitionedRuntime&) = delete;
+    PartitionedRuntime& operator=(const PartitionedRuntime&) = delete;
+    void run(istream& input, ostream& output, int command_count);
+    unsigned partitionCount() const;
+};
+
+/**
+ *  @brief  Start one pinned thread per partition
+ *  @param  partitions  number of partitions; at least 1
+ *  @param  queue_capacity  number of commands, and of results, queued per partition before the dispatching
+ *          thread waits
+ */
+PartitionedRuntime::PartitionedRuntime(const unsigned partitions, const size_t queue_capacity)
+{
+    const unsigned count = std::max(partitions, 1u);
+    for (unsigned i = 0; i < count; i++) _partitions.emplace_back(new Partition(queue_capacity));
+    for (unsigned i = 0; i < count; i++)
+    {
+        Partition& partition = *_partitions[i];
+        partition.worker = thread([&partition]() { _work(partition); });
+        _pin(partition.worker, i);
+    }
+}
+
+/**
+ *  @brief  Stop and join the threads of the partitions, once they have run every command sent to them
+ */
+PartitionedRuntime::~PartitionedRuntime()
+{
+    for (const unique_ptr<Partition>& partition : _partitions)
+    {
+        Request stop;
+        while (!partition->requests.tryPush(stop))
+        {
+            Response discarded;
+            partition->responses.tryPop(discarded);
+        }
+    }
+    for (const unique_ptr<Partition>& partition : _partitions) partition->worker.join();
+}
+
+/**
+ *  @brief  Pin a thread to a core, where the platform allows it
+ *  @param  worker  thread
+ *  @param  core  index of the core, wrapped around the number of hardware threads
+ */
+void PartitionedRuntime::_pin(thread& worker, const unsigned core)
+{
+#ifdef __linux__
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core % std::max(1u, thread::hardware_concurrency()), &cores);
+    pthread_setaffinity_np(worker.native_handle(), sizeof(cpu_set_t), &cores);
+#else
+    (void) worker;
+    (void) core;
+#endif
+}
+
+/**
+ *  @brief  Run the commands sent to a partition, in order, until told to stop
+ *  @param  partition  partition owned by the calling thread
+ */
+void PartitionedRuntime::_work(Partition& partition)
+{
+    Request request;
+    while (true)
+    {
+        if (!partition.requests.tryPop(request))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (request.kind == STOP) return;
+
+        Response response = _apply(partition.tree, request);
+        while (!partition.responses.tryPush(response)) std::this_thread::yield();
+    }
+}
+
+/**
+ *  @brief  Run a command on the tree of a partition
+ *  @param  tree  tree of the partition
+ *  @param  request  command
+ *  @return result of the command
+ */
+PartitionedRuntime::Response PartitionedRuntime::_apply(AVLTree& tree, const Request& request)
+{
+    Response response;
+    switch (request.kind)
+    {
+        case INSERT: response.is_successful = tree.insert(request.id, request.name); break;
+        case REMOVE: response.is_successful = tree.remove(request.id); break;
+        case REMOVE_INORDER: response.is_successful = tree.removeInorder(request.id); break;
+        case SEARCH_ID: response.text = tree.search(request.id); break;
+        case SEARCH_NAME: response.matches = tree.search(request.name); break;
+        case TRAVERSE: response.text = tree.traversalToString(request.traversal); break;
+        case LEVEL_COUNT: response.level_count = tree.levelCount(); break;
+        default: break;
+    }
+    return response;
+}
+
+/**
+ *  @brief  Find the partition whose range holds an ID
+ *  @param  id  integer ID, of 8 digits
+ *  @return index of the partition
+ */
+size_t PartitionedRuntime::_partitionOf(const int id) const
+{
+    return static_cast<size_t>(static_cast<long long>(id) * _partitions.size() / ID_LIMIT);
+}
+
+/**
+ *  @brief  Route a command to a partition, answering the oldest commands while its queue is full
+ *  @param  partition  index of the partition
+ *  @param  request  command, moved from
+ *  @param  output  stream to which answers are written
+ */
+void PartitionedRuntime::_send(const size_t partition, Request& request, ostream& output)
+{
+    _pending.push_back({request.kind, partition, ""});
+    while (!_partitions[partition]->requests.tryPush(request)) _complete(true, output);
+}
+
+/**
+ *  @brief  Route a command to every partition, answering the oldest commands while a queue is full
+ *  @param  request  command
+ *  @param  output  stream to which answers are written
+ */
+void PartitionedRuntime::_broadcast(const Request& request, ostream& output)
+{
+    _pending.push_back({request.kind, ALL, ""});
+    for (const unique_ptr<Partition>& partition : _partitions)
+    {
+        Request copy = request;
+        while (!partition->requests.tryPush(copy)) _complete(true, output);
+    }
+}
+
+/**
+ *  @brief  Queue a fixed answer behind the commands dispatched before it
+ *  @param  reply  answer
+ */
+void PartitionedRuntime::_reply(const string& reply)
+{
+    _pending.push_back({REPLY, 0, reply});
+}
+
+/**
+ *  @brief  Check whether a partition has answered its oldest unread command, reading the answer ahead
+ *  @param  partition  index of the partition
+ *  @return boolean indicating whether the answer is stashed
+ */
+bool PartitionedRuntime::_isAnswered(const size_t partition)
+{
+    Partition& owner = *_partitions[partition];
+    if (!owner.is_stashed) owner.is_stashed = owner.responses.tryPop(owner.stash);
+    return owner.is_stashed;
+}
+
+/**
+ *  @brief  Write the answer of the oldest pending command, as @c handleCommand would
+ *  @param  is_waiting  whether to wait for the partitions to answer
+ *  @param  output  stream to which the answer is written
+ *  @return boolean indicating whether an answer was written; @c false if none is pending, or if not waiting
+ *          and the partitions have yet to answer
+ *  @note   each partition answers its commands in the order they were sent, so the oldest pending command is
+ *          answered by the oldest unread answer of each partition it was sent to
+ */
+bool PartitionedRuntime::_complete(const bool is_waiting, ostream& output)
+{
+    if (_pending.empty()) return false;
+    const Pending pending = _pending.front();
+    if (pending.kind == REPLY)
+    {
+        output << pending.reply << '\n';
+        _pending.pop_front();
+        return true;
+    }
+
+    const size_t first = (pending.partition == ALL) ? 0 : pending.partition;
+    const size_t last = (pending.partition == ALL) ? _partitions.size() : pending.partition + 1;
+    for (size_t i = first; i < last; i++)
+    {
+        while (!_isAnswered(i))
+        {
+            if (!is_waiting) return false;
+            std::this_thread::yield();
+        }
+    }
+    _pending.pop_front();
+
+    Partition& owner = *_partitions[first];
+    switch (pending.kind)
+    {
+        case INSERT:
+        case REMOVE:
+        case REMOVE_INORDER:
+            if (owner.stash.is_successful)
+            {
+                if (pending.kind == INSERT) owner.size++; else owner.size--;
+            }
+            output << (owner.stash.is_successful ? "successful" : "unsuccessful") << '\n';
+            break;
+        case SEARCH_ID: output << (owner.stash.text.empty() ? "unsuccessful" : owner.stash.text) << '\n'; break;
+        case SEARCH_NAME:
+        {
+            bool is_found = false;
+            for (size_t i = first; i < last; i++)
+            {
+                for (const string& match : _partitions[i]->stash.matches) output << match << '\n';
+                is_found |= !_partitions[i]->stash.matches.empty();
+            }
+            if (!is_found) output << "unsuccessful" << '\n';
+            break;
+        }
+        case TRAVERSE:
+        {
+            string names;
+            for (size_t i = first; i < last; i++)
+            {
+                const string& part = _partitions[i]->stash.text;
+                if (part.empty()) continue;
+                if (!names.empty()) names += ", ";
+                names += part;
+            }
+            output << names << '\n';
+            break;
+        }
+        case LEVEL_COUNT:
+        {
+            int level_count = 0;
+            for (size_t i = first; i < last; i++) level_count = std::max(level_count, _partitions[i]->stash.level_count);
+            output << level_count << '\n';
+            break;
+        }
+        default: break;
+    }
+    for (size_t i = first; i < last; i++) _partitions[i]->is_stashed = false;
+    return true;
+}
+
+/**
+ *  @brief  Read one command and route it to the partitions that answer it, parsing it as @c handleCommand does
+ *  @param  input  stream from which the command is read
+ *  @param  output  stream to which the answers of older commands are written if a queue is full
+ */
+void PartitionedRuntime::_dispatch(istream& input, ostream& output)
+{
+    string command;
+    input >> command;
+    Request request;
+
+    if (command == "insert")
+    {
+        string name, id_str;
+        input.ignore();
+        getline(input, name, '\"');
+        getline(input, name, '\"');
+        input >> id_str;
+        if (!validateName(name) || !validateId(id_str)) return _reply("unsuccessful");
+        request.kind = INSERT;
+        request.id = as_int(id_str);
+        request.name = std::move(name);
+        return _send(_partitionOf(request.id), request, output);
+    }
+
+    if (command == "remove")
+    {
+        string id_str;
+        input >> id_str;
+        if (!validateId(id_str)) return _reply("unsuccessful");
+        request.kind = REMOVE;
+        request.id = as_int(id_str);
+        return _send(_partitionOf(request.id), request, output);
+    }
+
+    if (command == "search")
+    {
+        string arg;
+        input.ignore();
+        getline(input, arg, '\n');
+        if (validateId(arg))
+        {
+            request.kind = SEARCH_ID;
+            request.id = as_int(arg);
+            return _send(_partitionOf(request.id), request, output);
+        }
+        request.name = arg.substr(1, arg.length() - 2);
+        if (!validateName(request.name)) return _reply("unsuccessful");
+        request.kind = SEARCH_NAME;
+        return _broadcast(request, output);
+    }
+
+    request.kind = TRAVERSE;
+    if (command == "printInorder") { request.traversal = AVLTree::INORDER; return _broadcast(request, output); }
+    if (command == "printPreorder") { request.traversal = AVLTree::PREORDER; return _broadcast(request, output); }
+    if (command == "printPostorder") { request.traversal = AVLTree::POSTORDER; return _broadcast(request, output); }
+    if (command == "printLevelorder") { request.traversal = AVLTree::LEVELORDER; return _broadcast(request, output); }
+
+    if (command == "printLevelCount")
+    {
+        request.kind = LEVEL_COUNT;
+        return _broadcast(request, output);
+    }
+
+    if (command == "removeInorder")
+    {
+        string count_str;
+        input >> count_str;
+        if (!validateCount(count_str)) return _reply("unsuccessful");
+
+        while (_complete(true, output)) {} // the partition sizes are exact once every command is answered
+        int count = as_int(count_str);
+        for (size_t i = 0; i < _partitions.size(); i++)
+        {
+            if (static_cast<size_t>(count) >= _partitions[i]->size)
+            {
+                count -= static_cast<int>(_partitions[i]->size);
+                continue;
+            }
+            request.kind = REMOVE_INORDER;
+            request.id = count;
+            return _send(i, request, output);
+        }
+        return _reply("unsuccessful");
+    }
+
+    _reply("unsuccessful");
+}
+
+/**
+ *  @brief  Read and run commands, writing their answers in the order of the commands
+ *  @param  input  stream from which the commands are read, in the format of @c handleCommand
+ *  @param  output  stream to which the answers are written
+ *  @param  command_count  number of commands to read
+ *  @note   answers for IDs, for inorder traversals and for inorder counts match those of @c handleCommand on
+ *          a single tree; searches by name, the other traversals and the level count depend on the shape of
+ *          the tree, and are answered for the partitions' trees in range order instead
+ */
+void PartitionedRuntime::run(istream& input, ostream& output, int command_count)
+{
+    while (command_count--)
+    {
+        _dispatch(input, output);
+        while (_complete(false, output)) {}
+    }
+    while (_complete(true, output)) {}
+    output.flush();
+}
+
+/**
+ *  @brief  Get the number of partitions, each with its own thread
+ *  @return number of partitions
+ */
+unsigned PartitionedRuntime::partitionCount() const
+{
+    return static_cast<unsigned>(_partitions.size());
+}
+
+#endif //PARTITIONEDRUNTIME_H
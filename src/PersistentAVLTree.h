@@ -0,0 +1,509 @@
+#ifndef PERSISTENTAVLTREE_H
+#define PERSISTENTAVLTREE_H
+
+#include "AVLTree.h"
+#include "EpochManager.h"
+#include <string>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+using std::string;
+using std::vector;
+using std::queue;
+using std::shared_ptr;
+using std::make_shared;
+using std::mutex;
+using std::lock_guard;
+using std::atomic;
+using std::to_string;
+
+/// Object class for an immutable node of a persistent tree, shared by every version that reaches it
+class PersistentNode {
+
+public:
+    typedef shared_ptr<const PersistentNode> Pointer;
+    const Pointer left;
+    const Pointer right;
+    const int height;
+    const size_t size; // number of Nodes in the subtree, for positional removal
+    const int id;
+    const shared_ptr<const string> name; // shared by the copies of a Node along later paths
+
+    PersistentNode(Pointer l, int i, shared_ptr<const string> s, Pointer r) :
+            left(std::move(l)), right(std::move(r)),
+            height(1 + std::max(left ? left->height : -1, right ? right->height : -1)),
+            size(1 + (left ? left->size : 0) + (right ? right->size : 0)), id(i), name(std::move(s)) {}
+};
+
+/// Object class for a self-balancing tree whose updates copy the path to the change and publish a new root
+/// atomically, so that readers work on an immutable version without blocking or being blocked
+class PersistentAVLTree {
+
+private:
+    typedef PersistentNode::Pointer Pointer;
+    atomic<Pointer*> _version; // owner of the current root, swapped by writers and read by pinned readers
+    mutex _writer; // serializes writers, each of which derives the next version from the latest
+    explicit PersistentAVLTree(Pointer root);
+    static EpochManager& _epochs();
+    const Pointer& _current() const;
+    void _publish(Pointer root);
+    static int _getHeight(const Pointer& root);
+    static Pointer _balance(const Pointer& left, const PersistentNode& key, const Pointer& right);
+    static Pointer _insert(const Pointer& root, int id, const string& name, bool& is_inserted);
+    static Pointer _removeLeftmost(const Pointer& root, Pointer& leftmost);
+    static Pointer _unlink(const Pointer& root);
+    static Pointer _remove(const Pointer& root, int id, bool& is_removed);
+    static Pointer _removeInorder(const Pointer& root, size_t count);
+    static void _copyInorder(const Pointer& root, string& names);
+    static void _copyPreorder(const Pointer& root, string& names);
+    static void _copyPostorder(const Pointer& root, string& names);
+    static void _copyLevelorder(const Pointer& root, string& names);
+    static void _search(const Pointer& root, const string& name, vector<string>& matches);
+
+public:
+    enum Traversal { INORDER, PREORDER, POSTORDER, LEVELORDER };
+    PersistentAVLTree();
+    ~PersistentAVLTree();
+    PersistentAVLTree(PersistentAVLTree&& other) noexcept;
+    PersistentAVLTree(const PersistentAVLTree&) = delete;
+    PersistentAVLTree& operator=(const PersistentAVLTree&) = delete;
+    PersistentAVLTree snapshot() const;
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    bool removeInorder(int count);
+    string search(int id) const;
+    vector<string> search(const string& name) const;
+    string traversalToString(Traversal type) const;
+    int levelCount() const;
+    size_t size() const;
+};
+
+/**
+ *  @brief  Create an empty tree
+ */
+PersistentAVLTree::PersistentAVLTree() : _version(new Pointer()) {}
+
+/**
+ *  @brief  Create a tree whose current version is an existing one
+ *  @param  root  pointer to the root @c PersistentNode of the version
+ */
+PersistentAVLTree::PersistentAVLTree(Pointer root) : _version(new Pointer(std::move(root))) {}
+
+/**
+ *  @brief  Release the current version of @c this tree; no operation may be in progress. Replaced versions are
+ *          released by the epoch manager
+ */
+PersistentAVLTree::~PersistentAVLTree()
+{
+    delete _version.load();
+}
+
+/**
+ *  @brief  Create a tree taking over the current version of another, which is left empty
+ *  @param  other  tree
+ */
+PersistentAVLTree::PersistentAVLTree(PersistentAVLTree&& other) noexcept :
+        _version(other._version.exchange(new Pointer())) {}
+
+/**
+ *  @brief  Get the epoch manager shared by every tree, which releases replaced versions once no reader can
+ *          hold them
+ *  @return epoch manager
+ */
+EpochManager& PersistentAVLTree::_epochs()
+{
+    static EpochManager epochs;
+    return epochs;
+}
+
+/**
+ *  @brief  Get the current version of @c this tree, for a caller pinned to the epoch manager or holding the
+ *          writer lock
+ *  @return pointer to the root @c PersistentNode of the version; it and everything it reaches stay allocated
+ *          and unchanged until the caller unpins or releases the lock
+ */
+const PersistentAVLTree::Pointer& PersistentAVLTree::_current() const
+{
+    return *_version.load();
+}
+
+/**
+ *  @brief  Publish a new version of @c this tree, retiring the one it replaces; the writer lock must be held
+ *  @param  root  pointer to the root @c PersistentNode of the new version
+ */
+void PersistentAVLTree::_publish(Pointer root)
+{
+    Pointer* replaced = _version.exchange(new Pointer(std::move(root)));
+    _epochs().retire(replaced); // readers pinned before the exchange may still be reading it
+}
+
+/**
+ *  @brief  Get the height of a tree branch
+ *  @param  root  pointer to the root @c PersistentNode of the tree branch
+ *  @return height of the tree branch; -1 if empty
+ */
+int PersistentAVLTree::_getHeight(const Pointer& root)
+{
+    return root ? root->height : -1;
+}
+
+/**
+ *  @brief  Create a balanced tree branch from two subtrees and the ID and name of a @c PersistentNode,
+ *          creating new @c PersistentNodes for the rotations an update requires
+ *  @param  left  pointer to the root @c PersistentNode of the subtree of lesser IDs
+ *  @param  key  @c PersistentNode whose ID and name are placed between the subtrees
+ *  @param  right  pointer to the root @c PersistentNode of the subtree of greater IDs
+ *  @return pointer to the root @c PersistentNode of the new tree branch
+ *  @complexity O(1) (worst-case)
+ */
+PersistentAVLTree::Pointer PersistentAVLTree::_balance(const Pointer& left, const PersistentNode& key,
+                                                       const Pointer& right)
+{
+    const int left_height = _getHeight(left);
+    const int right_height = _getHeight(right);
+    if (left_height > right_height + 1)
+    {
+        if (_getHeight(left->left) >= _getHeight(left->right)) // left-left: rotate clockwise
+            return make_shared<const PersistentNode>(
+                    left->left, left->id, left->name,
+                    make_shared<const PersistentNode>(left->right, key.id, key.name, right));
+        const Pointer& pivot = left->right; // left-right: rotate twice
+        return make_shared<const PersistentNode>(
+                make_shared<const PersistentNode>(left->left, left->id, left->name, pivot->left),
+                pivot->id, pivot->name,
+                make_shared<const PersistentNode>(pivot->right, key.id, key.name, right));
+    }
+    if (right_height > left_height + 1)
+    {
+        if (_getHeight(right->right) >= _getHeight(right->left)) // right-right: rotate counterclockwise
+            return make_shared<const PersistentNode>(
+                    make_shared<const PersistentNode>(left, key.id, key.name, right->left),
+                    right->id, right->name, right->right);
+        const Pointer& pivot = right->left; // right-left: rotate twice
+        return make_shared<const PersistentNode>(
+                make_shared<const PersistentNode>(left, key.id, key.name, pivot->left),
+                pivot->id, pivot->name,
+                make_shared<const PersistentNode>(pivot->right, right->id, right->name, right->right));
+    }
+    return make_shared<const PersistentNode>(left, key.id, key.name, right);
+}
+
+/**
+ *  @brief  Create the version of a tree with an ID and name inserted, copying the path to the new leaf
+ *  @param  root  pointer to the root @c PersistentNode of the tree
+ *  @param  id  integer ID
+ *  @param  name  full name
+ *  @param  is_inserted  boolean set to whether the ID was absent and is inserted
+ *  @return pointer to the root @c PersistentNode of the new version; the same tree if the ID is present
+ *  @complexity O(log n) (worst-case)
+ */
+PersistentAVLTree::Pointer PersistentAVLTree::_insert(const Pointer& root, const int id, const string& name,
+                                                      bool& is_inserted)
+{
+    if (!root)
+    {
+        is_inserted = true;
+        return make_shared<const PersistentNode>(nullptr, id, make_shared<const string>(name), nullptr);
+    }
+    if (id == root->id) return root;
+
+    if (id < root->id)
+    {
+        Pointer left = _insert(root->left, id, name, is_inserted);
+        return is_inserted ? _balance(left, *root, root->right) : root;
+    }
+    Pointer right = _insert(root->right, id, name, is_inserted);
+    return is_inserted ? _balance(root->left, *root, right) : root;
+}
+
+/**
+ *  @brief  Create the version of a tree without its leftmost @c PersistentNode
+ *  @param  root  pointer to the root @c PersistentNode of the tree
+ *  @param  leftmost  pointer to which the leftmost @c PersistentNode is copied
+ *  @return pointer to the root @c PersistentNode of the new version
+ *  @complexity O(log n) (worst-case)
+ */
+PersistentAVLTree::Pointer PersistentAVLTree::_removeLeftmost(const Pointer& root, Pointer& leftmost)
+{
+    if (!root->left)
+    {
+        leftmost = root;
+        return root->right;
+    }
+    return _balance(_removeLeftmost(root->left, leftmost), *root, root->right);
+}
+
+/**
+ *  @brief  Create the version of a tree without its root @c PersistentNode, whose inorder successor takes its place
+ *  @param  root  pointer to the root @c PersistentNode of the tree
+ *  @return pointer to the root @c PersistentNode of the new version
+ *  @complexity O(log n) (worst-case)
+ */
+PersistentAVLTree::Pointer PersistentAVLTree::_unlink(const Pointer& root)
+{
+    if (!root->left) return root->right;
+    if (!root->right) return root->left;
+
+    Pointer successor;
+    Pointer right = _removeLeftmost(root->right, successor);
+    return _balance(root->left, *successor, right);
+}
+
+/**
+ *  @brief  Create the version of a tree without an ID, copying the path to the change
+ *  @param  root  pointer to the root @c PersistentNode of the tree
+ *  @param  id  integer ID
+ *  @param  is_removed  boolean set to whether the ID was found and is removed
+ *  @return pointer to the root @c PersistentNode of the new version; the same tree if the ID is absent
+ *  @complexity O(log n) (worst-case)
+ */
+PersistentAVLTree::Pointer PersistentAVLTree::_remove(const Pointer& root, const int id, bool& is_removed)
+{
+    if (!root) return root;
+    if (id == root->id)
+    {
+        is_removed = true;
+        return _unlink(root);
+    }
+
+    if (id < root->id)
+    {
+        Pointer left = _remove(root->left, id, is_removed);
+        return is_removed ? _balance(left, *root, root->right) : root;
+    }
+    Pointer right = _remove(root->right, id, is_removed);
+    return is_removed ? _balance(root->left, *root, right) : root;
+}
+
+/**
+ *  @brief  Create the version of a tree without the @c PersistentNode at an inorder count, found by subtree sizes
+ *  @param  root  pointer to the root @c PersistentNode of the tree
+ *  @param  count  inorder count, less than the size of the tree
+ *  @return pointer to the root @c PersistentNode of the new version
+ *  @complexity O(log n) (worst-case)
+ */
+PersistentAVLTree::Pointer PersistentAVLTree::_removeInorder(const Pointer& root, const size_t count)
+{
+    const size_t left_size = root->left ? root->left->size : 0;
+    if (count == left_size) return _unlink(root);
+    if (count < left_size) return _balance(_removeInorder(root->left, count), *root, root->right);
+    return _balance(root->left, *root, _removeInorder(root->right, count - left_size - 1));
+}
+
+/**
+ *  @brief Copies a comma-separated inorder traversal to a string
+ *  @param root  pointer to the root @c PersistentNode of a tree
+ *  @param names  string to which names list is copied
+ */
+void PersistentAVLTree::_copyInorder(const Pointer& root, string& names)
+{
+    if (!root) return;
+
+    _copyInorder(root->left, names);
+    names += (*root->name + ", ");
+    _copyInorder(root->right, names);
+}
+
+/**
+ *  @brief Copies a comma-separated preorder traversal to a string
+ *  @param root  pointer to the root @c PersistentNode of a tree
+ *  @param names  string to which names list is copied
+ */
+void PersistentAVLTree::_copyPreorder(const Pointer& root, string& names)
+{
+    if (!root) return;
+
+    names += (*root->name + ", ");
+    _copyPreorder(root->left, names);
+    _copyPreorder(root->right, names);
+}
+
+/**
+ *  @brief Copies a comma-separated postorder traversal to a string
+ *  @param root  pointer to the root @c PersistentNode of a tree
+ *  @param names  string to which names list is copied
+ */
+void PersistentAVLTree::_copyPostorder(const Pointer& root, string& names)
+{
+    if (!root) return;
+
+    _copyPostorder(root->left, names);
+    _copyPostorder(root->right, names);
+    names += (*root->name + ", ");
+}
+
+/**
+ *  @brief Copies a comma-separated levelorder traversal to a string
+ *  @param root  pointer to the root @c PersistentNode of a tree
+ *  @param names  string to which names list is copied
+ */
+void PersistentAVLTree::_copyLevelorder(const Pointer& root, string& names)
+{
+    if (!root) return;
+
+    queue<const PersistentNode*> nodes_queue;
+    nodes_queue.push(root.get());
+    while (!nodes_queue.empty())
+    {
+        const PersistentNode* current = nodes_queue.front();
+        nodes_queue.pop();
+
+        names += (*current->name + ", ");
+        if (current->left) nodes_queue.push(current->left.get());
+        if (current->right) nodes_queue.push(current->right.get());
+    }
+}
+
+/**
+ *  @brief Search, by name, and copy a list of IDs from a tree
+ *  @param root  pointer to the root @c PersistentNode of the tree
+ *  @param name  full name
+ *  @param matches vector to which list of IDs is to be copied
+ *  @complexity O(n) (worst-case)
+ */
+void PersistentAVLTree::_search(const Pointer& root, const string& name, vector<string>& matches)
+{
+    if (!root) return;
+
+    if (*root->name == name) matches.push_back(AVLTree::idToString(root->id));
+    _search(root->left, name, matches);
+    _search(root->right, name, matches);
+}
+
+/**
+ *  @brief  Take a point-in-time snapshot of @c this tree
+ *  @return tree whose current version is that of @c this tree; later updates to either do not affect the other
+ *  @complexity O(1) (worst-case)
+ */
+PersistentAVLTree PersistentAVLTree::snapshot() const
+{
+    EpochManager::Guard guard(_epochs());
+    return PersistentAVLTree(_current());
+}
+
+/**
+ *  @brief  Insert an ID and name to @c this tree, publishing a new version
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the ID was inserted successfully
+ *  @complexity O(log n) (worst-case)
+ */
+bool PersistentAVLTree::insert(const int id, const string& name)
+{
+    lock_guard<mutex> lock(_writer);
+    bool is_inserted = false;
+    Pointer root = _insert(_current(), id, name, is_inserted);
+    if (is_inserted) _publish(std::move(root));
+    return is_inserted;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove an entry from @c this tree, publishing a new version
+ *  @param  id integer ID
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(log n) (worst-case)
+ */
+bool PersistentAVLTree::remove(const int id)
+{
+    lock_guard<mutex> lock(_writer);
+    bool is_removed = false;
+    Pointer root = _remove(_current(), id, is_removed);
+    if (is_removed) _publish(std::move(root));
+    return is_removed;
+}
+
+/**
+ *  @brief  Identify, by inorder count, and remove an entry from @c this tree, publishing a new version
+ *  @param  count inorder count
+ *  @return boolean indicating whether an entry was removed
+ *  @complexity O(log n) (worst-case)
+ */
+bool PersistentAVLTree::removeInorder(const int count)
+{
+    lock_guard<mutex> lock(_writer);
+    const Pointer& root = _current();
+    if (count < 0 || !root || static_cast<size_t>(count) >= root->size) return false;
+    _publish(_removeInorder(root, static_cast<size_t>(count)));
+    return true;
+}
+
+/**
+ *  @brief  Search for an ID from the current version of @c this tree
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @complexity O(log n) (worst-case)
+ */
+string PersistentAVLTree::search(const int id) const
+{
+    EpochManager::Guard guard(_epochs());
+    const PersistentNode* node = _current().get();
+    while (node && node->id != id) node = (id < node->id) ? node->left.get() : node->right.get();
+    return node ? *node->name : "";
+}
+
+/**
+ *  @brief  Search for a name from the current version of @c this tree
+ *  @param  name  full name
+ *  @return list of 8-character IDs with the name, in preorder
+ */
+vector<string> PersistentAVLTree::search(const string& name) const
+{
+    EpochManager::Guard guard(_epochs());
+    vector<string> matches;
+    _search(_current(), name, matches);
+    return matches;
+}
+
+/**
+ *  @brief  Get a comma-separated list of names from the current version of @c this tree, consistent even
+ *          while writers publish later versions
+ *  @param  type type of tree traversal to generate the list from
+ *  @return comma-separated list of names as a string
+ *  @complexity O(n) (worst-case)
+ */
+string PersistentAVLTree::traversalToString(const Traversal type) const
+{
+    EpochManager::Guard guard(_epochs());
+    const Pointer& root = _current();
+    if (!root) return "";
+    string names;
+
+    switch (type)
+    {
+        case INORDER: _copyInorder(root, names); break;
+        case PREORDER: _copyPreorder(root, names); break;
+        case POSTORDER: _copyPostorder(root, names); break;
+        case LEVELORDER: _copyLevelorder(root, names); break;
+        default: return "";
+    }
+
+    names.pop_back(); // removes the last space
+    names.pop_back(); // removes the last comma
+    return names;
+}
+
+/**
+ *  @brief  Get the number of levels from root to most distant leaf of the current version of @c this tree
+ *  @return highest level of @c this tree
+ */
+int PersistentAVLTree::levelCount() const
+{
+    EpochManager::Guard guard(_epochs());
+    return _getHeight(_current()) + 1;
+}
+
+/**
+ *  @brief  Get the number of IDs in the current version of @c this tree
+ *  @return number of IDs
+ */
+size_t PersistentAVLTree::size() const
+{
+    EpochManager::Guard guard(_epochs());
+    const Pointer& root = _current();
+    return root ? root->size : 0;
+}
+
+#endif //PERSISTENTAVLTREE_H
@@ -0,0 +1,157 @@
+#ifndef PRESENCEBITMAP_H
+#define PRESENCEBITMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+using std::vector;
+
+/// Object class for a dense bitmap of the IDs present in the 8-digit domain, with a popcount-based rank
+class PresenceBitmap {
+
+private:
+    vector<uint64_t> _words; // one bit per ID
+    vector<uint32_t> _blockCounts; // Fenwick tree over the number of IDs in each block of words
+    size_t _count = 0;
+    static const size_t BLOCK_WORDS = 8;
+    void _addToBlock(size_t block, int delta);
+    static size_t _popcount(uint64_t word);
+
+public:
+    static const int ID_LIMIT = 100000000;
+    PresenceBitmap();
+    static bool inDomain(int id);
+    bool test(int id) const;
+    bool set(int id);
+    bool reset(int id);
+    void clear();
+    size_t rank(int id) const;
+    size_t count() const;
+};
+
+/**
+ *  @brief  Create an empty bitmap covering IDs 00000000 through 99999999
+ */
+PresenceBitmap::PresenceBitmap() :
+        _words((ID_LIMIT + 63) / 64), _blockCounts(_words.size() / BLOCK_WORDS + 2) {}
+
+/**
+ *  @brief  Check whether an ID can be represented in the bitmap
+ *  @param  id  integer ID
+ *  @return boolean indicating whether the ID lies in the 8-digit domain
+ */
+bool PresenceBitmap::inDomain(const int id)
+{
+    return id >= 0 && id < ID_LIMIT;
+}
+
+/**
+ *  @brief  Add to the number of IDs counted for a block of words and every Fenwick range covering it
+ *  @param  block  index of the block
+ *  @param  delta  change in the number of IDs
+ */
+void PresenceBitmap::_addToBlock(size_t block, const int delta)
+{
+    for (block++; block < _blockCounts.size(); block += block & (~block + 1)) _blockCounts[block] += delta;
+}
+
+/**
+ *  @brief  Count the set bits of a word
+ *  @param  word  64-bit word
+ *  @return number of set bits
+ */
+size_t PresenceBitmap::_popcount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count = 0;
+    for (; word; word &= word - 1) count++;
+    return count;
+#endif
+}
+
+/**
+ *  @brief  Check whether an ID is present
+ *  @param  id  integer ID in the 8-digit domain
+ *  @return boolean indicating whether the ID is present
+ *  @complexity O(1)
+ */
+bool PresenceBitmap::test(const int id) const
+{
+    return (_words[id >> 6] >> (id & 63)) & 1;
+}
+
+/**
+ *  @brief  Mark an ID as present
+ *  @param  id  integer ID in the 8-digit domain
+ *  @return boolean indicating whether the ID was absent before
+ *  @complexity O(log n) (worst-case)
+ */
+bool PresenceBitmap::set(const int id)
+{
+    uint64_t& word = _words[id >> 6];
+    const uint64_t bit = uint64_t(1) << (id & 63);
+    if (word & bit) return false;
+    word |= bit;
+    _addToBlock((id >> 6) / BLOCK_WORDS, 1);
+    _count++;
+    return true;
+}
+
+/**
+ *  @brief  Mark an ID as absent
+ *  @param  id  integer ID in the 8-digit domain
+ *  @return boolean indicating whether the ID was present before
+ *  @complexity O(log n) (worst-case)
+ */
+bool PresenceBitmap::reset(const int id)
+{
+    uint64_t& word = _words[id >> 6];
+    const uint64_t bit = uint64_t(1) << (id & 63);
+    if (!(word & bit)) return false;
+    word &= ~bit;
+    _addToBlock((id >> 6) / BLOCK_WORDS, -1);
+    _count--;
+    return true;
+}
+
+/**
+ *  @brief  Mark every ID as absent
+ */
+void PresenceBitmap::clear()
+{
+    std::fill(_words.begin(), _words.end(), 0);
+    std::fill(_blockCounts.begin(), _blockCounts.end(), 0);
+    _count = 0;
+}
+
+/**
+ *  @brief  Count the present IDs less than an ID: the preceding blocks through the Fenwick tree,
+ *          then the preceding words of the ID's block by popcount
+ *  @param  id  integer ID in the 8-digit domain
+ *  @return number of present IDs less than the ID
+ *  @complexity O(log n) (worst-case)
+ */
+size_t PresenceBitmap::rank(const int id) const
+{
+    const size_t word_index = static_cast<size_t>(id) >> 6;
+    const size_t block = word_index / BLOCK_WORDS;
+
+    size_t rank = 0;
+    for (size_t i = block; i > 0; i -= i & (~i + 1)) rank += _blockCounts[i];
+    for (size_t i = block * BLOCK_WORDS; i < word_index; i++) rank += _popcount(_words[i]);
+    rank += _popcount(_words[word_index] & ((uint64_t(1) << (id & 63)) - 1));
+    return rank;
+}
+
+/**
+ *  @brief  Get the number of present IDs
+ *  @return number of present IDs
+ */
+size_t PresenceBitmap::count() const
+{
+    return _count;
+}
+
+#endif //PRESENCEBITMAP_H
@@ -0,0 +1,396 @@
+#ifndef SHARDEDAVLTREE_H
+#define SHARDEDAVLTREE_H
+
+#include "AVLTree.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <algorithm>
+using std::atomic;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::shared_lock;
+using std::shared_timed_mutex;
+using std::unique_ptr;
+
+/// Object class for a set of IDs and names partitioned by ID range into @c AVLTree shards, each behind its own
+/// lock, whose ranges are split and joined online to keep the shards of similar sizes
+class ShardedAVLTree {
+
+public:
+    static const int ID_LIMIT = 100000000; // the 8-digit ID space is divided evenly among the initial shards
+    static const size_t SKEW_FACTOR = 2; // a shard holding more than this times the average is split
+    static const size_t MIN_SPLIT_SIZE = 64; // shards no larger than this above the skew bound are left as they are
+
+private:
+    /// Range of IDs from its least ID up to the least ID of the next shard
+    struct Shard {
+        int low; // least ID of the range; the first shard also takes every lesser ID
+        mutex lock;
+        AVLTree tree;
+        atomic<size_t> size{0};
+        explicit Shard(const int l) : low(l) {}
+    };
+
+    vector<unique_ptr<Shard>> _shards; // in order of range
+    shared_timed_mutex _table; // held shared by operations, exclusively while shards are split and joined
+    atomic<size_t> _splitBound{MIN_SPLIT_SIZE}; // shard size above which single inserts flag a rebalancing
+    atomic<bool> _needsRebalance{false};
+    size_t _rebalanceCount = 0;
+    size_t _shardOf(int id) const;
+    size_t _totalSize() const;
+    bool _isSkewed(size_t shard_size, size_t total_size) const;
+    void _noteSkew();
+    void _rebalance();
+
+public:
+    explicit ShardedAVLTree(size_t shard_count = thread::hardware_concurrency());
+    ShardedAVLTree(const ShardedAVLTree&) = delete;
+    ShardedAVLTree& operator=(const ShardedAVLTree&) = delete;
+    bool insert(int id, const string& name);
+    bool remove(int id);
+    string search(int id);
+    size_t insertBatch(vector<pair<int, string>>&& entries, ThreadPool& pool);
+    size_t removeBatch(const vector<int>& ids, ThreadPool& pool);
+    vector<string> searchBatch(const vector<int>& ids, ThreadPool& pool);
+    string traversalToString();
+    void rebalance();
+    size_t size();
+    vector<size_t> shardSizes();
+    size_t rebalanceCount();
+};
+
+/**
+ *  @brief  Create an empty set of shards dividing the 8-digit ID space evenly
+ *  @param  shard_count  number of shards, kept by rebalancing; at least 1
+ */
+ShardedAVLTree::ShardedAVLTree(const size_t shard_count)
+{
+    const size_t count = std::max<size_t>(shard_count, 1);
+    for (size_t i = 0; i < count; i++)
+        _shards.emplace_back(new Shard(static_cast<int>(static_cast<long long>(ID_LIMIT) * i / count)));
+}
+
+/**
+ *  @brief  Find the shard whose range holds an ID; the table lock is held
+ *  @param  id  integer ID
+ *  @return position of the shard
+ *  @complexity O(log s) (worst-case), for s shards
+ */
+size_t ShardedAVLTree::_shardOf(const int id) const
+{
+    const auto next = std::upper_bound(_shards.begin() + 1, _shards.end(), id,
+                                       [](const int key, const unique_ptr<Shard>& shard) { return key < shard->low; });
+    return static_cast<size_t>(next - _shards.begin()) - 1;
+}
+
+/**
+ *  @brief  Count the IDs in every shard; the table lock is held
+ *  @return number of IDs
+ *  @complexity O(s) (worst-case), for s shards
+ */
+size_t ShardedAVLTree::_totalSize() const
+{
+    size_t total = 0;
+    for (const unique_ptr<Shard>& shard : _shards) total += shard->size;
+    return total;
+}
+
+/**
+ *  @brief  Check whether a shard holds so many more IDs than the average that it should be split
+ *  @param  shard_size  number of IDs in the shard
+ *  @param  total_size  number of IDs in every shard
+ *  @return boolean indicating whether the shard is skewed
+ */
+bool ShardedAVLTree::_isSkewed(const size_t shard_size, const size_t total_size) const
+{
+    return shard_size > SKEW_FACTOR * total_size / _shards.size() + MIN_SPLIT_SIZE;
+}
+
+/**
+ *  @brief  Flag a rebalancing if any shard has become skewed, and recompute the bound checked by single inserts;
+ *          the table lock is held
+ */
+void ShardedAVLTree::_noteSkew()
+{
+    const size_t total = _totalSize();
+    for (const unique_ptr<Shard>& shard : _shards) if (_isSkewed(shard->size, total)) _needsRebalance = true;
+    _splitBound = SKEW_FACTOR * total / _shards.size() + MIN_SPLIT_SIZE;
+}
+
+/**
+ *  @brief  Split the largest shard at its median while it is skewed, joining the adjacent pair of shards with the
+ *          fewest IDs for each split so that the number of shards is kept; the table lock is held exclusively
+ *  @complexity O(n / s) (worst-case) per split, for s shards, to find the median
+ */
+void ShardedAVLTree::_rebalance()
+{
+    const size_t total = _totalSize(); // splits and joins move IDs between shards but keep their number
+    for (size_t round = 0; round < _shards.size(); round++)
+    {
+        Shard* largest = _shards[0].get();
+        for (const unique_ptr<Shard>& shard : _shards) if (shard->size > largest->size) largest = shard.get();
+        if (!_isSkewed(largest->size, total)) break;
+
+        size_t joined = _shards.size(); // left shard of the pair to join; none if no pair stays below the bound
+        for (size_t i = 0; i + 1 < _shards.size(); i++)
+        {
+            if (_shards[i].get() == largest || _shards[i + 1].get() == largest) continue;
+            const size_t pair_size = _shards[i]->size + _shards[i + 1]->size;
+            if (_isSkewed(pair_size, total)) continue;
+            if (joined == _shards.size() || pair_size < _shards[joined]->size + _shards[joined + 1]->size) joined = i;
+        }
+        if (joined != _shards.size())
+        {
+            Shard& left = *_shards[joined];
+            left.tree.unionWith(std::move(_shards[joined + 1]->tree)); // the ranges are disjoint and adjacent
+            left.size += _shards[joined + 1]->size;
+            _shards.erase(_shards.begin() + static_cast<long>(joined) + 1);
+        }
+
+        size_t position = 0;
+        while (_shards[position].get() != largest) position++;
+        const size_t lower_size = largest->size / 2;
+        unique_ptr<Shard> upper(new Shard(largest->tree.selectInorder(static_cast<int>(lower_size))));
+        upper->tree.unionWith(largest->tree.splitOff(upper->low));
+        upper->size = largest->size - lower_size;
+        largest->size = lower_size;
+        _shards.insert(_shards.begin() + static_cast<long>(position) + 1, std::move(upper));
+        _rebalanceCount++;
+    }
+    _splitBound = SKEW_FACTOR * total / _shards.size() + MIN_SPLIT_SIZE;
+}
+
+/**
+ *  @brief  Create, with ID and name, and insert a @c Node to the shard of the ID, then rebalance if the shard
+ *          has outgrown the skew bound as of the last count of every shard
+ *  @param  id  integer ID
+ *  @param  name full name
+ *  @return boolean indicating whether the node was inserted successfully
+ *  @note   only the shard's own count is written, so inserts to different shards share no cache line; a bound
+ *          left low by growth elsewhere flags a rebalancing that finds nothing to split and raises it again
+ *  @complexity O(log n) (worst-case), plus the occasional rebalancing
+ */
+bool ShardedAVLTree::insert(const int id, const string& name)
+{
+    {
+        shared_lock<shared_timed_mutex> table(_table);
+        Shard& shard = *_shards[_shardOf(id)];
+        lock_guard<mutex> lock(shard.lock);
+        if (!shard.tree.insert(id, name)) return false;
+        shard.size++;
+        if (shard.size > _splitBound.load(std::memory_order_relaxed)) _needsRebalance = true;
+    }
+    if (_needsRebalance.load(std::memory_order_relaxed) && _needsRebalance.exchange(false)) rebalance();
+    return true;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove a @c Node from the shard of the ID
+ *  @param  id integer ID
+ *  @return boolean indicating whether a node was removed
+ *  @complexity O(log n) (worst-case)
+ */
+bool ShardedAVLTree::remove(const int id)
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    Shard& shard = *_shards[_shardOf(id)];
+    lock_guard<mutex> lock(shard.lock);
+    if (!shard.tree.remove(id)) return false;
+    shard.size--;
+    return true;
+}
+
+/**
+ *  @brief  Search for an ID from the shard of the ID
+ *  @param  id integer ID
+ *  @return name corresponding to the found ID; empty if not found
+ *  @complexity O(log n) (worst-case)
+ */
+string ShardedAVLTree::search(const int id)
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    Shard& shard = *_shards[_shardOf(id)];
+    lock_guard<mutex> lock(shard.lock);
+    return shard.tree.search(id);
+}
+
+/**
+ *  @brief  Create, with IDs and names, and insert a batch of @c Nodes, one task per shard on a pool
+ *  @param  entries  list of pairs of integer ID and full name, in any order
+ *  @param  pool  pool onto which the shards' batches are forked
+ *  @return number of entries inserted; as with repeated calls to @c insert, only the first of several entries
+ *          sharing an ID is inserted
+ *  @complexity O(k log(n/k + 1) + k log k) work (worst-case), spread over the shards
+ */
+size_t ShardedAVLTree::insertBatch(vector<pair<int, string>>&& entries, ThreadPool& pool)
+{
+    size_t inserted = 0;
+    {
+        shared_lock<shared_timed_mutex> table(_table);
+        vector<vector<pair<int, string>>> groups(_shards.size());
+        for (pair<int, string>& entry : entries) groups[_shardOf(entry.first)].push_back(std::move(entry));
+
+        vector<size_t> counts(_shards.size());
+        vector<shared_ptr<ThreadPool::Task>> tasks;
+        for (size_t i = 0; i < groups.size(); i++)
+        {
+            if (groups[i].empty()) continue;
+            tasks.push_back(pool.fork([this, &groups, &counts, i]()
+            {
+                Shard& shard = *_shards[i];
+                lock_guard<mutex> lock(shard.lock);
+                const vector<bool> results = shard.tree.insertBatch(std::move(groups[i]));
+                counts[i] = static_cast<size_t>(std::count(results.begin(), results.end(), true));
+                shard.size += counts[i];
+            }));
+        }
+        for (const shared_ptr<ThreadPool::Task>& task : tasks) pool.join(task);
+        for (size_t count : counts) inserted += count;
+        _noteSkew();
+    }
+    if (_needsRebalance.load(std::memory_order_relaxed) && _needsRebalance.exchange(false)) rebalance();
+    return inserted;
+}
+
+/**
+ *  @brief  Identify, by ID, and remove a batch of @c Nodes, one task per shard on a pool
+ *  @param  ids  list of integer IDs, in any order
+ *  @param  pool  pool onto which the shards' batches are forked
+ *  @return number of removed nodes
+ *  @complexity O(k log n) work (worst-case), spread over the shards
+ */
+size_t ShardedAVLTree::removeBatch(const vector<int>& ids, ThreadPool& pool)
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    vector<vector<int>> groups(_shards.size());
+    for (int id : ids) groups[_shardOf(id)].push_back(id);
+
+    vector<size_t> counts(_shards.size());
+    vector<shared_ptr<ThreadPool::Task>> tasks;
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        if (groups[i].empty()) continue;
+        tasks.push_back(pool.fork([this, &groups, &counts, i]()
+        {
+            Shard& shard = *_shards[i];
+            lock_guard<mutex> lock(shard.lock);
+            counts[i] = shard.tree.removeBatch(groups[i]);
+            shard.size -= counts[i];
+        }));
+    }
+    for (const shared_ptr<ThreadPool::Task>& task : tasks) pool.join(task);
+
+    size_t removed = 0;
+    for (size_t count : counts) removed += count;
+    return removed;
+}
+
+/**
+ *  @brief  Search for a batch of IDs, one task per shard on a pool
+ *  @param  ids  list of integer IDs
+ *  @param  pool  pool onto which the shards' batches are forked
+ *  @return list of names corresponding to the IDs, in the same order; empty where an ID is not found
+ *  @complexity O(k log n) work (worst-case), spread over the shards
+ */
+vector<string> ShardedAVLTree::searchBatch(const vector<int>& ids, ThreadPool& pool)
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    vector<vector<int>> groups(_shards.size());
+    vector<vector<size_t>> positions(_shards.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        const size_t shard = _shardOf(ids[i]);
+        groups[shard].push_back(ids[i]);
+        positions[shard].push_back(i);
+    }
+
+    vector<string> matches(ids.size());
+    vector<shared_ptr<ThreadPool::Task>> tasks;
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        if (groups[i].empty()) continue;
+        tasks.push_back(pool.fork([this, &groups, &positions, &matches, i]()
+        {
+            Shard& shard = *_shards[i];
+            vector<string> shard_matches;
+            {
+                lock_guard<mutex> lock(shard.lock);
+                shard_matches = shard.tree.searchBatch(groups[i]);
+            }
+            for (size_t j = 0; j < shard_matches.size(); j++) matches[positions[i][j]] = std::move(shard_matches[j]);
+        }));
+    }
+    for (const shared_ptr<ThreadPool::Task>& task : tasks) pool.join(task);
+    return matches;
+}
+
+/**
+ *  @brief  Get a comma-separated inorder list of names, concatenating the shards in order of range
+ *  @return comma-separated list of names as a string
+ *  @note   every shard is locked, in order of range, before any is read, so the list is a consistent snapshot
+ *  @complexity O(n) (worst-case)
+ */
+string ShardedAVLTree::traversalToString()
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    vector<unique_lock<mutex>> locks;
+    for (const unique_ptr<Shard>& shard : _shards) locks.emplace_back(shard->lock);
+
+    string names;
+    for (const unique_ptr<Shard>& shard : _shards)
+    {
+        const string shard_names = shard->tree.traversalToString(AVLTree::INORDER);
+        if (shard_names.empty()) continue;
+        if (!names.empty()) names += ", ";
+        names += shard_names;
+    }
+    return names;
+}
+
+/**
+ *  @brief  Split skewed shards and join small ones, excluding every other operation meanwhile
+ */
+void ShardedAVLTree::rebalance()
+{
+    unique_lock<shared_timed_mutex> table(_table);
+    _rebalance();
+}
+
+/**
+ *  @brief  Get the number of IDs in every shard
+ *  @return number of IDs
+ *  @complexity O(s) (worst-case), for s shards
+ */
+size_t ShardedAVLTree::size()
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    return _totalSize();
+}
+
+/**
+ *  @brief  Get the number of IDs in each shard
+ *  @return list of sizes, in order of range
+ */
+vector<size_t> ShardedAVLTree::shardSizes()
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    vector<size_t> sizes;
+    for (const unique_ptr<Shard>& shard : _shards) sizes.push_back(shard->size);
+    return sizes;
+}
+
+/**
+ *  @brief  Get the number of shards split by rebalancing so far
+ *  @return number of splits
+ */
+size_t ShardedAVLTree::rebalanceCount()
+{
+    shared_lock<shared_timed_mutex> table(_table);
+    return _rebalanceCount;
+}
+
+#endif //SHARDEDAVLTREE_H
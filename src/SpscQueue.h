@@ -0,0 +1,109 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <memory>
+using std::atomic;
+using std::unique_ptr;
+
+/// Object class for a bounded lock-free queue between exactly one producer thread and one consumer thread
+template <typename T>
+class SpscQueue {
+
+private:
+    // the positions are kept a cache line apart by padding rather than alignas, which heap allocation does not
+    // honour before C++17
+    static const size_t CACHE_LINE = 64;
+    const size_t _mask; // capacity - 1, the capacity being a power of 2
+    unique_ptr<T[]> _slots;
+    char _headPadding[CACHE_LINE];
+    atomic<size_t> _head{0}; // position of the next item to pop; written by the consumer only
+    char _tailPadding[CACHE_LINE];
+    atomic<size_t> _tail{0}; // position of the next item to push; written by the producer only
+    char _cachedHeadPadding[CACHE_LINE];
+    size_t _cachedHead = 0; // producer's last read of the head, refreshed only when the queue looks full
+    char _cachedTailPadding[CACHE_LINE];
+    size_t _cachedTail = 0; // consumer's last read of the tail, refreshed only when the queue looks empty
+    char _endPadding[CACHE_LINE];
+    static size_t _roundUp(size_t capacity);
+
+public:
+    explicit SpscQueue(size_t capacity);
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    bool tryPush(T& item);
+    bool tryPop(T& item);
+    size_t capacity() const;
+};
+
+/**
+ *  @brief  Round a capacity up to a power of 2
+ *  @param  capacity  least capacity
+ *  @return power of 2 no less than the capacity, and at least 2
+ */
+template <typename T>
+size_t SpscQueue<T>::_roundUp(const size_t capacity)
+{
+    size_t rounded = 2;
+    while (rounded < capacity) rounded *= 2;
+    return rounded;
+}
+
+/**
+ *  @brief  Create an empty queue
+ *  @param  capacity  least number of items held at once; rounded up to a power of 2
+ */
+template <typename T>
+SpscQueue<T>::SpscQueue(const size_t capacity) : _mask(_roundUp(capacity) - 1), _slots(new T[_mask + 1]) {}
+
+/**
+ *  @brief  Push an item, from the producer thread, unless the queue is full
+ *  @param  item  item, moved from only if pushed
+ *  @return boolean indicating whether the item was pushed
+ *  @complexity O(1) (worst-case)
+ */
+template <typename T>
+bool SpscQueue<T>::tryPush(T& item)
+{
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _cachedHead > _mask)
+    {
+        _cachedHead = _head.load(std::memory_order_acquire);
+        if (tail - _cachedHead > _mask) return false;
+    }
+    _slots[tail & _mask] = std::move(item);
+    _tail.store(tail + 1, std::memory_order_release); // publishes the slot
+    return true;
+}
+
+/**
+ *  @brief  Pop the oldest item, from the consumer thread, unless the queue is empty
+ *  @param  item  item to which the popped item is moved
+ *  @return boolean indicating whether an item was popped
+ *  @complexity O(1) (worst-case)
+ */
+template <typename T>
+bool SpscQueue<T>::tryPop(T& item)
+{
+    const size_t head = _head.load(std::memory_order_relaxed);
+    if (head == _cachedTail)
+    {
+        _cachedTail = _tail.load(std::memory_order_acquire);
+        if (head == _cachedTail) return false;
+    }
+    item = std::move(_slots[head & _mask]);
+    _head.store(head + 1, std::memory_order_release); // hands the slot back to the producer
+    return true;
+}
+
+/**
+ *  @brief  Get the number of items the queue holds at once
+ *  @return capacity
+ */
+template <typename T>
+size_t SpscQueue<T>::capacity() const
+{
+    return _mask + 1;
+}
+
+#endif //SPSCQUEUE_H
@@ -0,0 +1,232 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+using std::vector;
+using std::deque;
+using std::thread;
+using std::mutex;
+using std::unique_lock;
+using std::condition_variable;
+using std::function;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::atomic;
+
+/// Object class for a fixed set of worker threads running fork-join tasks, each from its own queue and stealing
+/// from the others' when it runs dry
+class ThreadPool {
+
+public:
+    /// Object class for a forked unit of work and its completion state
+    struct Task {
+        function<void()> work;
+        bool is_done = false;
+    };
+
+private:
+    /// Queue of the tasks forked by one thread; its owner takes the newest, thieves the oldest
+    struct WorkQueue {
+        mutex lock;
+        deque<shared_ptr<Task>> tasks;
+    };
+
+    vector<thread> _workers;
+    vector<unique_ptr<WorkQueue>> _queues; // one per worker, after one for the threads outside the pool
+    atomic<size_t> _queued{0}; // tasks in all queues
+    mutex _mutex; // guards the completion of tasks and the sleep of idle threads
+    condition_variable _changed;
+    bool _is_stopping = false;
+    static thread_local ThreadPool* _currentPool; // pool of the calling worker; nullptr outside any pool
+    static thread_local size_t _currentQueue; // queue of the calling worker in its pool
+    size_t _ownQueue() const;
+    bool _take(size_t own, shared_ptr<Task>& task);
+    void _run(const shared_ptr<Task>& task);
+    void _work(size_t index);
+
+public:
+    explicit ThreadPool(unsigned concurrency = thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    unsigned concurrency() const;
+    shared_ptr<Task> fork(function<void()> work);
+    void join(const shared_ptr<Task>& task);
+};
+
+thread_local ThreadPool* ThreadPool::_currentPool = nullptr;
+thread_local size_t ThreadPool::_currentQueue = 0;
+
+/**
+ *  @brief  Create a pool whose workers, together with the thread that joins their tasks, number the concurrency
+ *  @param  concurrency  number of threads that run tasks, including the joining thread
+ */
+ThreadPool::ThreadPool(const unsigned concurrency)
+{
+    for (unsigned i = 0; i < std::max(concurrency, 1u); i++) _queues.emplace_back(new WorkQueue());
+    for (unsigned i = 1; i < concurrency; i++) _workers.emplace_back([this, i]() { _work(i); });
+}
+
+/**
+ *  @brief  Stop and join the workers of @c this pool once the queued tasks have run
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        unique_lock<mutex> lock(_mutex);
+        _is_stopping = true;
+    }
+    _changed.notify_all();
+    for (thread& worker : _workers) worker.join();
+}
+
+/**
+ *  @brief  Get the number of threads that run tasks of @c this pool, including the joining thread
+ *  @return number of threads
+ */
+unsigned ThreadPool::concurrency() const
+{
+    return static_cast<unsigned>(_workers.size()) + 1;
+}
+
+/**
+ *  @brief  Get the queue onto which the calling thread forks
+ *  @return index of the queue of the calling worker; 0 for threads outside @c this pool
+ */
+size_t ThreadPool::_ownQueue() const
+{
+    return (_currentPool == this) ? _currentQueue : 0;
+}
+
+/**
+ *  @brief  Take the newest task of a queue or, if it is empty, steal the oldest task of another
+ *  @param  own  index of the queue of the calling thread
+ *  @param  task  pointer to which the task is assigned
+ *  @return boolean indicating whether a task was taken
+ *  @note   the owner keeps working on the subproblems it has just forked, which are hot in its cache, while
+ *          thieves take the oldest, which in fork-join recursion are the largest
+ */
+bool ThreadPool::_take(const size_t own, shared_ptr<Task>& task)
+{
+    if (!_queued.load()) return false;
+    for (size_t i = 0; i < _queues.size(); i++)
+    {
+        WorkQueue& queue = *_queues[(own + i) % _queues.size()];
+        unique_lock<mutex> lock(queue.lock);
+        if (queue.tasks.empty()) continue;
+
+        if (!i)
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        _queued--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  @brief  Run a task and signal its completion
+ *  @param  task  task taken from a queue
+ */
+void ThreadPool::_run(const shared_ptr<Task>& task)
+{
+    task->work();
+    {
+        unique_lock<mutex> lock(_mutex);
+        task->is_done = true;
+    }
+    _changed.notify_all();
+}
+
+/**
+ *  @brief  Run tasks, from the queue of a worker first, until @c this pool is stopped
+ *  @param  index  index of the queue of the worker
+ */
+void ThreadPool::_work(const size_t index)
+{
+    _currentPool = this;
+    _currentQueue = index;
+    shared_ptr<Task> task;
+    while (true)
+    {
+        if (_take(index, task))
+        {
+            _run(task);
+            continue;
+        }
+
+        unique_lock<mutex> lock(_mutex);
+        _changed.wait(lock, [this]() { return _is_stopping || _queued.load(); });
+        if (_is_stopping && !_queued.load()) return;
+    }
+}
+
+/**
+ *  @brief  Queue a unit of work to run on any thread of @c this pool
+ *  @param  work  function to run
+ *  @return task to be joined before the results of the work are used
+ */
+shared_ptr<ThreadPool::Task> ThreadPool::fork(function<void()> work)
+{
+    shared_ptr<Task> task = std::make_shared<Task>();
+    task->work = std::move(work);
+    if (_workers.empty())
+    {
+        _run(task);
+        return task;
+    }
+    {
+        WorkQueue& queue = *_queues[_ownQueue()];
+        unique_lock<mutex> lock(queue.lock);
+        queue.tasks.push_back(task);
+        _queued++;
+    }
+    {
+        unique_lock<mutex> lock(_mutex); // a worker about to sleep has either seen the task or is waiting
+    }
+    _changed.notify_one();
+    return task;
+}
+
+/**
+ *  @brief  Wait for a task to complete, running the newest tasks of the calling thread's queue, or stealing,
+ *          meanwhile
+ *  @param  task  task returned by @c fork
+ */
+void ThreadPool::join(const shared_ptr<Task>& task)
+{
+    const size_t own = _ownQueue();
+    shared_ptr<Task> next;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(_mutex);
+            if (task->is_done) return;
+        }
+        if (_take(own, next))
+        {
+            _run(next);
+            continue;
+        }
+
+        unique_lock<mutex> lock(_mutex);
+        _changed.wait(lock, [this, &task]() { return task->is_done || _queued.load(); });
+    }
+}
+
+#endif //THREADPOOL_H
@@ -8,6 +8,6 @@ int main()
     cin >> command_count; // read in the number of commands
     AVLTree tree; // instantiate a tree object
     // run down the counter while handling commands
-    while (command_count--) tree = handleCommand(tree);
+    while (command_count--) tree = handleCommand(std::move(tree));
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,21 @@
 #include "../src/AVLTree.h"
+#include "../src/LearnedIndex.h"
+#include "../src/BlockAVLTree.h"
+#include "../src/AdaptiveAVLTree.h"
+#include "../src/ConcurrentAVLTree.h"
+#include "../src/PersistentAVLTree.h"
+#include "../src/OptimisticAVLTree.h"
+#include "../src/EpochManager.h"
+#include "../src/FlatCombiningAVLTree.h"
+#include "../src/ShardedAVLTree.h"
+#include "../src/PartitionedRuntime.h"
+#include <map>
+#include <set>
+#include <cmath>
+#include <random>
+#include <sstream>
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS // Catch 2.13.3 alt-stack sizing does not compile against glibc >= 2.34
 #include "catch.hpp"
 
 TEST_CASE("Insertraverse")
@@ -78,4 +94,1157 @@ TEST_CASE("Back removeInorder")
         REQUIRE(tree.removeInorder(count));
     }
     REQUIRE(!tree.levelCount());
-}
\ No newline at end of file
+}
+
+TEST_CASE("Search batch")
+{
+    AVLTree tree;
+    for (int id = 10000000; id <= 10001000; id += 2)
+    {
+        string name = to_string(id);
+        tree.insert(id, name);
+    }
+    vector<int> ids;
+    for (int id = 10001001; id >= 9999999; id--) ids.push_back(id);
+    vector<string> matches = tree.searchBatch(ids);
+    REQUIRE(matches.size() == ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        REQUIRE(matches[i] == tree.search(ids[i]));
+    }
+    REQUIRE(AVLTree().searchBatch(ids) == vector<string>(ids.size()));
+}
+
+TEST_CASE("Parallel name search")
+{
+    // large enough that several levels of subtrees are forked, with matches on both sides of every fork
+    vector<pair<int, string>> entries;
+    for (int id = 0; id < 200000; id++) entries.emplace_back(id, id % 29999 == 0 ? "rare" : id % 2 ? "odd" : "even");
+    AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+    for (unsigned threads : {1u, 4u})
+    {
+        ThreadPool pool(threads);
+        for (const string name : {"even", "odd", "rare", "absent"})
+        {
+            REQUIRE(tree.search(name, pool) == tree.search(name));
+        }
+    }
+    REQUIRE(tree.search("rare").size() == 7);
+    ThreadPool pool(2);
+    REQUIRE(AVLTree().search("even", pool).empty());
+}
+
+TEST_CASE("Parallel traversal")
+{
+    // levels wider than a chunk, and subtrees both above and below the cutoff height
+    AVLTree tree;
+    std::mt19937 generator(49);
+    std::uniform_int_distribution<int> ids(0, 99999999);
+    for (int i = 0; i < 150000; i++)
+    {
+        const int id = ids(generator);
+        tree.insert(id, to_string(id % 977));
+    }
+    AVLTree single;
+    single.insert(12345678, "Only");
+    for (unsigned threads : {1u, 4u})
+    {
+        ThreadPool pool(threads);
+        for (AVLTree::Traversal type : {AVLTree::INORDER, AVLTree::PREORDER, AVLTree::POSTORDER, AVLTree::LEVELORDER})
+        {
+            REQUIRE(tree.traversalToString(type, pool) == tree.traversalToString(type));
+            REQUIRE(single.traversalToString(type, pool) == "Only");
+            REQUIRE(AVLTree().traversalToString(type, pool).empty());
+        }
+    }
+}
+
+TEST_CASE("Insert batch")
+{
+    AVLTree tree, expected;
+    for (int id = 10000000; id <= 10001000; id += 2)
+    {
+        string name = to_string(id);
+        tree.insert(id, name);
+        expected.insert(id, name);
+    }
+    vector<pair<int, string>> entries;
+    for (int id = 10001020; id >= 10000980; id--) entries.emplace_back(id, to_string(id));
+    entries.emplace_back(10001001, "duplicate");
+    vector<bool> expected_results;
+    for (const auto& entry : entries) expected_results.push_back(expected.insert(entry.first, entry.second));
+
+    vector<bool> results = tree.insertBatch(std::move(entries));
+    REQUIRE(results == expected_results);
+    REQUIRE(tree.traversalToString(tree.INORDER) == expected.traversalToString(expected.INORDER));
+    REQUIRE(tree.search(10001001) == "10001001");
+    REQUIRE(tree.levelCount() <= 11);
+}
+
+TEST_CASE("Insert batch larger than tree")
+{
+    AVLTree tree;
+    string expected_inorder;
+    for (int id = 10000000; id <= 10000010; id++) tree.insert(id, to_string(id));
+    vector<pair<int, string>> entries;
+    for (int id = 10001000; id >= 10000005; id--) entries.emplace_back(id, to_string(id));
+
+    vector<bool> results = tree.insertBatch(std::move(entries));
+    for (size_t i = 0; i < results.size(); i++) REQUIRE(results[i] == (i < results.size() - 6));
+    for (int id = 10000000; id <= 10001000; id++) expected_inorder += to_string(id) + ", ";
+    expected_inorder.pop_back();
+    expected_inorder.pop_back();
+    REQUIRE(tree.traversalToString(tree.INORDER) == expected_inorder);
+    REQUIRE(tree.levelCount() == 10);
+}
+
+TEST_CASE("Remove rebalance")
+{
+    AVLTree tree;
+    for (int id = 10000000; id < 10001024; id++) tree.insert(id, to_string(id));
+    for (int id = 10000000; id < 10000768; id++) REQUIRE(tree.remove(id));
+    REQUIRE(!tree.remove(10000000));
+    REQUIRE(tree.levelCount() <= 9);
+    REQUIRE(tree.removeInorder(255));
+    REQUIRE(!tree.removeInorder(255));
+    REQUIRE(tree.search(10001023).empty());
+    REQUIRE(AVLTree().remove(10000000) == false);
+}
+
+TEST_CASE("Build from sorted")
+{
+    vector<pair<int, string>> entries;
+    string expected_inorder;
+    for (int id = 10000000; id < 10001023; id++)
+    {
+        entries.emplace_back(id, to_string(id));
+        expected_inorder += to_string(id) + ", ";
+    }
+    expected_inorder.pop_back();
+    expected_inorder.pop_back();
+
+    AVLTree tree = AVLTree::buildFromSorted(entries.begin(), entries.end());
+    REQUIRE(tree.traversalToString(tree.INORDER) == expected_inorder);
+    REQUIRE(tree.levelCount() == 10);
+
+    std::swap(entries.front(), entries.back());
+    entries.push_back(entries.front());
+    AVLTree unsorted = AVLTree::buildFromSorted(entries.begin(), entries.end());
+    REQUIRE(unsorted.traversalToString(unsorted.INORDER) == expected_inorder);
+}
+
+TEST_CASE("Build from sorted in parallel")
+{
+    vector<pair<int, string>> entries;
+    for (int id = 10000000; id < 10100000; id++) entries.emplace_back(id, to_string(id));
+
+    AVLTree expected = AVLTree::buildFromSorted(entries.begin(), entries.end());
+    ThreadPool pool(4);
+    AVLTree tree = AVLTree::buildFromSortedParallel(entries.begin(), entries.end(), pool);
+    REQUIRE(tree.traversalToString(tree.PREORDER) == expected.traversalToString(expected.PREORDER));
+    REQUIRE(tree.levelCount() == 17);
+    REQUIRE(tree.insert(10100000, "10100000"));
+}
+
+TEST_CASE("Split and join")
+{
+    AVLTree tree;
+    for (int id = 10000000; id < 10001000; id++) tree.insert(id, to_string(id));
+    const string expected_inorder = tree.traversalToString(tree.INORDER);
+
+    AVLTree left, right;
+    string name;
+    REQUIRE(tree.split(10000300, left, name, right));
+    REQUIRE(name == "10000300");
+    REQUIRE(tree.levelCount() == 0);
+    REQUIRE(left.search(10000299) == "10000299");
+    REQUIRE(left.search(10000300).empty());
+    REQUIRE(right.search(10000301) == "10000301");
+    REQUIRE(right.levelCount() <= 11);
+
+    AVLTree joined = AVLTree::join(std::move(left), 10000300, name, std::move(right));
+    REQUIRE(joined.traversalToString(joined.INORDER) == expected_inorder);
+    REQUIRE(joined.levelCount() <= 11);
+    REQUIRE(left.levelCount() == 0);
+
+    REQUIRE(!joined.split(9999999, left, name, right));
+    REQUIRE(left.levelCount() == 0);
+    REQUIRE(right.traversalToString(right.INORDER) == expected_inorder);
+}
+
+TEST_CASE("Join out of order")
+{
+    AVLTree left, right;
+    for (int id = 10000000; id < 10000010; id++) left.insert(id, to_string(id));
+    for (int id = 10000005; id < 10000020; id++) right.insert(id, to_string(id));
+
+    AVLTree joined = AVLTree::join(std::move(left), 10000003, "duplicate", std::move(right));
+    REQUIRE(joined.search(10000003) == "10000003");
+    REQUIRE(joined.removeInorder(19));
+    REQUIRE(!joined.removeInorder(19));
+}
+
+TEST_CASE("Split off")
+{
+    AVLTree tree;
+    for (int id = 10000000; id < 10000100; id++) tree.insert(id, to_string(id));
+
+    AVLTree upper = tree.splitOff(10000050);
+    REQUIRE(upper.search(10000050) == "10000050");
+    REQUIRE(tree.search(10000050).empty());
+    REQUIRE(tree.search(10000049) == "10000049");
+    REQUIRE(upper.removeInorder(49));
+    REQUIRE(!upper.removeInorder(49));
+    REQUIRE(tree.removeInorder(49));
+    REQUIRE(!tree.removeInorder(49));
+
+    AVLTree all = upper.splitOff(10000000);
+    REQUIRE(upper.levelCount() == 0);
+    REQUIRE(all.levelCount() == 6);
+}
+
+TEST_CASE("Set operations")
+{
+    ThreadPool pool(4);
+    for (ThreadPool* executor : {static_cast<ThreadPool*>(nullptr), &pool})
+    {
+        vector<pair<int, string>> evens, threes;
+        for (int id = 10000000; id < 10060000; id += 2) evens.emplace_back(id, "even");
+        for (int id = 10000000; id < 10060000; id += 3) threes.emplace_back(id, "three");
+
+        AVLTree united = AVLTree::buildFromSorted(evens.begin(), evens.end());
+        united.unionWith(AVLTree::buildFromSorted(threes.begin(), threes.end()), AVLTree::KEEP_OTHER, executor);
+        REQUIRE(united.search(10000006) == "three");
+        REQUIRE(united.search(10000004) == "even");
+        REQUIRE(united.search(10000009) == "three");
+        REQUIRE(united.search(10000001).empty());
+        REQUIRE(united.levelCount() <= 22);
+
+        AVLTree common = AVLTree::buildFromSorted(evens.begin(), evens.end());
+        common.intersect(AVLTree::buildFromSorted(threes.begin(), threes.end()), AVLTree::KEEP_THIS, executor);
+        REQUIRE(common.search(10000006) == "even");
+        REQUIRE(common.search(10000004).empty());
+        REQUIRE(common.search(10000009).empty());
+        REQUIRE(common.removeInorder(9999));
+        REQUIRE(!common.removeInorder(9999));
+
+        AVLTree rest = AVLTree::buildFromSorted(evens.begin(), evens.end());
+        rest.difference(AVLTree::buildFromSorted(threes.begin(), threes.end()), executor);
+        REQUIRE(rest.search(10000006).empty());
+        REQUIRE(rest.search(10000004) == "even");
+        REQUIRE(rest.removeInorder(19999));
+        REQUIRE(!rest.removeInorder(19999));
+    }
+}
+
+TEST_CASE("Work-stealing pool")
+{
+    // nested forks from workers land on their own queues, and idle threads steal them
+    ThreadPool pool(4);
+    std::function<long(int)> fibonacci = [&pool, &fibonacci](const int n) -> long
+    {
+        if (n < 12) return n < 2 ? n : fibonacci(n - 1) + fibonacci(n - 2);
+        long left = 0;
+        shared_ptr<ThreadPool::Task> task = pool.fork([&left, &fibonacci, n]() { left = fibonacci(n - 1); });
+        const long right = fibonacci(n - 2);
+        pool.join(task);
+        return left + right;
+    };
+    REQUIRE(fibonacci(24) == 46368);
+
+    ThreadPool inline_pool(1);
+    REQUIRE(inline_pool.concurrency() == 1);
+    int runs = 0;
+    inline_pool.join(inline_pool.fork([&runs]() { runs++; }));
+    REQUIRE(runs == 1);
+}
+
+TEST_CASE("Freeze")
+{
+    for (int count : {0, 1, 2, 7, 8, 1000})
+    {
+        AVLTree tree;
+        for (int id = 0; id < count; id++) tree.insert(10000000 + 3 * id, to_string(id));
+        FrozenAVLTree frozen = tree.freeze();
+        REQUIRE(frozen.size() == static_cast<size_t>(count));
+
+        vector<int> ids;
+        for (int id = 9999990; id <= 10000010 + 3 * count; id++) ids.push_back(id);
+        vector<string> matches = frozen.searchBatch(ids);
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            REQUIRE(frozen.search(ids[i]) == tree.search(ids[i]));
+            REQUIRE(matches[i] == tree.search(ids[i]));
+        }
+    }
+}
+
+TEST_CASE("Compact")
+{
+    AVLTree tree;
+    for (int id = 10000000; id < 10004000; id++) tree.insert(id, "name " + to_string(id));
+    for (int id = 10000000; id < 10004000; id += 3) tree.remove(id);
+    const string expected_preorder = tree.traversalToString(tree.PREORDER);
+    const AVLTree::LayoutStats before = tree.layoutStats();
+
+    tree.compact();
+    const AVLTree::LayoutStats after = tree.layoutStats();
+    REQUIRE(tree.traversalToString(tree.PREORDER) == expected_preorder);
+    REQUIRE(after.page_span <= (2666 * sizeof(Node)) / 4096 + 2);
+    REQUIRE(after.page_span <= before.page_span);
+    REQUIRE(after.page_crossing_ratio < 0.25);
+
+    REQUIRE(tree.insert(10000000, "10000000"));
+    REQUIRE(tree.remove(10000001));
+    REQUIRE(tree.search(10000002) == "name 10000002");
+    tree.compact();
+    REQUIRE(tree.search(10000000) == "10000000");
+
+    AVLTree upper = tree.splitOff(10002000);
+    tree.compact();
+    for (int id = 10002000; id < 10004000; id++) upper.remove(id);
+    REQUIRE(upper.levelCount() == 0);
+    REQUIRE(tree.search(10001999) == "name 10001999");
+
+    // while frees are deferred, the arenas that compacting drops outlive the Nodes retired from them
+    vector<Node*> retired;
+    tree.deferFrees(&retired);
+    tree.compact();
+    REQUIRE(tree.remove(10000004));
+    tree.compact();
+    REQUIRE(retired.size() > 2000);
+    tree.deferFrees(nullptr);
+    tree.releaseDeferred(retired);
+    REQUIRE(retired.empty());
+    REQUIRE(tree.search(10000005) == "name 10000005");
+    REQUIRE(tree.search(10000004).empty());
+}
+
+TEST_CASE("Clone and clear")
+{
+    // Nodes in an arena and allocated individually, with both indexes enabled
+    AVLTree tree;
+    for (int id = 10000000; id < 10060000; id += 2) tree.insert(id, "name " + to_string(id));
+    tree.compact();
+    REQUIRE(tree.clone().layoutStats().mean_edge_bytes == tree.layoutStats().mean_edge_bytes); // same slots
+    for (int id = 10000001; id < 10001000; id += 2) tree.insert(id, "name " + to_string(id));
+    tree.enablePresenceBitmap();
+    tree.enableHashIndex();
+
+    ThreadPool pool(4);
+    for (ThreadPool* clone_pool : {static_cast<ThreadPool*>(nullptr), &pool})
+    {
+        AVLTree copy = tree.clone(clone_pool);
+        for (AVLTree::Traversal type : {AVLTree::INORDER, AVLTree::PREORDER, AVLTree::POSTORDER, AVLTree::LEVELORDER})
+        {
+            REQUIRE(copy.traversalToString(type) == tree.traversalToString(type));
+        }
+
+        // the copy shares no Node or index with the original
+        REQUIRE(copy.remove(10000002));
+        REQUIRE(copy.insert(10001001, "copy"));
+        REQUIRE(tree.search(10000002) == "name 10000002");
+        REQUIRE(tree.search(10001001).empty());
+        REQUIRE(copy.search(10000002).empty());
+        REQUIRE(copy.search(10001001) == "copy");
+    }
+
+    AVLTree copy = tree;
+    AVLTree assigned;
+    assigned.insert(12345678, "replaced");
+    assigned = copy;
+    REQUIRE(assigned.traversalToString(AVLTree::INORDER) == tree.traversalToString(AVLTree::INORDER));
+    AVLTree moved = std::move(copy);
+    REQUIRE(copy.traversalToString(AVLTree::INORDER).empty());
+    REQUIRE(moved.search(10059998) == "name 10059998");
+    assigned = std::move(moved);
+    REQUIRE(moved.search(10059998).empty());
+    REQUIRE(assigned.search(10059998) == "name 10059998");
+
+    // a large tree is freed in the background, and its indexes are cleared at once
+    tree.clear();
+    REQUIRE(tree.traversalToString(AVLTree::INORDER).empty());
+    REQUIRE(tree.search(10000000).empty());
+    REQUIRE(tree.insert(10000000, "again"));
+    REQUIRE(tree.search(10000000) == "again");
+    assigned.clear();
+    NodeReleaser::wait();
+    REQUIRE(assigned.levelCount() == 0);
+
+    // a tree deferring its frees retires its Nodes when assigned to, and keeps their arenas until released
+    AVLTree deferring;
+    for (int id = 0; id < 3000; id++) deferring.insert(id, to_string(id));
+    deferring.compact();
+    vector<Node*> retired;
+    deferring.deferFrees(&retired);
+    AVLTree replacement;
+    for (int id = 5000; id < 5100; id++) replacement.insert(id, to_string(id));
+    replacement.compact();
+    deferring = std::move(replacement);
+    REQUIRE(retired.size() == 3000);
+    REQUIRE(deferring.remove(5000));
+    REQUIRE(retired.size() == 3001);
+    AVLTree taken = std::move(deferring); // the arena of the retired Node 5000 moves, and must outlive it
+    REQUIRE(taken.remove(5001));
+    REQUIRE(retired.size() == 3001);
+    deferring.releaseDeferred(retired);
+    REQUIRE(taken.search(5099) == "5099");
+}
+
+TEST_CASE("Learned index")
+{
+    AVLTree tree;
+    int id = 10000000;
+    for (int i = 0; i < 20000; i++)
+    {
+        id += (i % 5000 == 0) ? 100000 : 1 + (i * 7919) % 13; // near-uniform blocks separated by gaps
+        tree.insert(id, to_string(id));
+    }
+    const vector<int> ids = tree.freeze().sortedIds();
+    REQUIRE(ids.size() == 20000);
+    REQUIRE(std::is_sorted(ids.begin(), ids.end()));
+
+    for (size_t epsilon : {1, 8, 64})
+    {
+        LearnedIndex index(ids, epsilon);
+        REQUIRE(index.segmentCount() < ids.size());
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            REQUIRE(index.find(ids[i]) == static_cast<long>(i));
+            REQUIRE(index.contains(ids[i] + 1) == !tree.search(ids[i] + 1).empty());
+        }
+        REQUIRE(!index.contains(ids.front() - 1));
+        REQUIRE(!index.contains(ids.back() + 1));
+    }
+    REQUIRE(!LearnedIndex({}).contains(10000000));
+}
+
+TEST_CASE("Presence bitmap")
+{
+    AVLTree tree;
+    for (int id = 10000000; id < 10001000; id += 2) tree.insert(id, to_string(id));
+    tree.enablePresenceBitmap();
+    REQUIRE(tree.rank(10000100) == 50);
+    REQUIRE(tree.rank(10000101) == 51);
+
+    REQUIRE(!tree.insert(10000000, "duplicate"));
+    REQUIRE(tree.insert(10000001, "10000001"));
+    REQUIRE(tree.search(10000001) == "10000001");
+    REQUIRE(tree.search(10000003).empty());
+    REQUIRE(tree.remove(10000001));
+    REQUIRE(tree.search(10000001).empty());
+    REQUIRE(tree.insert(10000001, "again"));
+    REQUIRE(tree.removeInorder(0));
+    REQUIRE(tree.search(10000000).empty());
+    REQUIRE(tree.insert(10000000, "10000000"));
+
+    vector<pair<int, string>> entries = {{10000003, "3"}, {10000004, "duplicate"}, {10000003, "duplicate"}};
+    REQUIRE(tree.insertBatch(std::move(entries)) == vector<bool>({true, false, false}));
+    REQUIRE(tree.search(10000003) == "3");
+    REQUIRE(tree.rank(10000005) == 5);
+
+    AVLTree upper = tree.splitOff(10000500);
+    REQUIRE(tree.search(10000500).empty());
+    REQUIRE(upper.search(10000500) == "10000500");
+    REQUIRE(tree.insert(10000500, "back"));
+
+    AVLTree others;
+    for (int id = 10000000; id < 10000010; id++) others.insert(id, "other");
+    tree.difference(std::move(others));
+    REQUIRE(tree.search(10000004).empty());
+    REQUIRE(tree.rank(10000020) == 5);
+
+    tree.compact();
+    REQUIRE(tree.search(10000012) == "10000012");
+    REQUIRE(!tree.insert(10000012, "duplicate"));
+}
+
+TEST_CASE("Hash index")
+{
+    AVLTree tree;
+    for (int id = 10000000; id < 10002000; id += 2) tree.insert(id, to_string(id));
+    tree.enableHashIndex();
+    REQUIRE(tree.hashIndexBytes() >= 1000 * 2 * 16);
+
+    REQUIRE(!tree.insert(10000000, "duplicate"));
+    REQUIRE(tree.insert(10000001, "10000001"));
+    REQUIRE(tree.search(10000001) == "10000001");
+    REQUIRE(tree.remove(10000001));
+    REQUIRE(tree.search(10000001).empty());
+    for (int id = 10000000; id < 10001000; id += 2) REQUIRE(tree.remove(id));
+    for (int id = 10001000; id < 10002000; id += 2) REQUIRE(tree.search(id) == to_string(id));
+    REQUIRE(tree.removeInorder(0));
+    REQUIRE(tree.search(10001000).empty());
+
+    AVLTree others;
+    for (int id = 10001500; id < 10002500; id++) others.insert(id, "other");
+    tree.unionWith(std::move(others), AVLTree::KEEP_THIS);
+    REQUIRE(tree.search(10001500) == "10001500");
+    REQUIRE(tree.search(10001501) == "other");
+
+    tree.compact();
+    REQUIRE(tree.search(10001998) == "10001998");
+    REQUIRE(!tree.insert(10001998, "duplicate"));
+
+    AVLTree upper = tree.splitOff(10002000);
+    REQUIRE(tree.search(10002000).empty());
+    REQUIRE(tree.insert(10002000, "back"));
+    REQUIRE(tree.search(10002000) == "back");
+
+    // trees emptied by a join or a set operation no longer find the moved Nodes through their indexes
+    AVLTree a;
+    AVLTree b;
+    for (int id = 1; id <= 5; id++) a.insert(id, to_string(id));
+    for (int id = 7; id <= 9; id++) b.insert(id, to_string(id));
+    a.enableHashIndex();
+    b.enablePresenceBitmap();
+    AVLTree joined = AVLTree::join(std::move(a), 6, "6", std::move(b));
+    REQUIRE(joined.hashIndexBytes() > 0);
+    REQUIRE(joined.remove(3));
+    REQUIRE(a.search(3).empty());
+    REQUIRE(b.search(8).empty());
+    REQUIRE(joined.search(3).empty());
+    REQUIRE(joined.search(8) == "8");
+    REQUIRE(!joined.insert(9, "duplicate"));
+
+    AVLTree merged;
+    merged.unionWith(std::move(joined));
+    REQUIRE(joined.search(4).empty());
+    REQUIRE(merged.remove(4));
+    REQUIRE(joined.search(4).empty());
+    AVLTree kept;
+    kept.insert(5, "5");
+    kept.enableHashIndex();
+    kept.intersect(std::move(merged));
+    REQUIRE(merged.search(5).empty());
+    REQUIRE(kept.search(5) == "5");
+}
+
+TEST_CASE("Block tree")
+{
+    BlockAVLTree tree;
+    AVLTree reference;
+    std::mt19937 generator(36);
+    for (int i = 0; i < 20000; i++)
+    {
+        const int id = 10000000 + static_cast<int>(generator() % 5000);
+        if (generator() % 3) REQUIRE(tree.insert(id, to_string(id)) == reference.insert(id, to_string(id)));
+        else REQUIRE(tree.remove(id) == reference.remove(id));
+    }
+    REQUIRE(tree.traversalToString(BlockAVLTree::INORDER) == reference.traversalToString(AVLTree::INORDER));
+    for (int id = 9999999; id <= 10005000; id++) REQUIRE(tree.search(id) == reference.search(id));
+    REQUIRE(tree.levelCount() < reference.levelCount());
+    REQUIRE(tree.memoryBytes() < tree.size() * sizeof(Node));
+
+    REQUIRE(tree.removeInorder(0) == reference.removeInorder(0));
+    REQUIRE(tree.removeInorder(100) == reference.removeInorder(100));
+    REQUIRE(!tree.removeInorder(static_cast<int>(tree.size())));
+    REQUIRE(tree.traversalToString(BlockAVLTree::INORDER) == reference.traversalToString(AVLTree::INORDER));
+
+    tree.insert(7, "Seven");
+    REQUIRE(tree.search("Seven") == vector<string>{"00000007"});
+    while (tree.removeInorder(0)) {}
+    REQUIRE(tree.size() == 0);
+    REQUIRE(tree.traversalToString(BlockAVLTree::PREORDER).empty());
+    REQUIRE(tree.levelCount() == 0);
+}
+
+TEST_CASE("Block tree traversals")
+{
+    BlockAVLTree tree;
+    for (int id = 1; id <= 100; id++) tree.insert(id, to_string(id));
+    for (int id = 1; id <= 100; id += 3) tree.remove(id);
+
+    // every traversal lists each remaining name exactly once
+    for (BlockAVLTree::Traversal type : {BlockAVLTree::PREORDER, BlockAVLTree::POSTORDER, BlockAVLTree::LEVELORDER})
+    {
+        string names = tree.traversalToString(type);
+        vector<int> ids;
+        for (size_t start = 0; start < names.size();)
+        {
+            const size_t end = std::min(names.find(", ", start), names.size());
+            ids.push_back(std::stoi(names.substr(start, end - start)));
+            start = end + 2;
+        }
+        std::sort(ids.begin(), ids.end());
+        REQUIRE(ids.size() == tree.size());
+        for (int id : ids) REQUIRE(id % 3 != 1);
+    }
+}
+
+TEST_CASE("Adaptive tree")
+{
+    AdaptiveAVLTree tree(8);
+    vector<pair<int, string>> entries;
+    for (int id = 10000007; id > 10000000; id--) REQUIRE(tree.insert(id, "Name" + string(1, 'A' + id % 2)));
+    for (int id = 10000001; id <= 10000007; id++) entries.emplace_back(id, "Name" + string(1, 'A' + id % 2));
+    REQUIRE(!tree.insert(10000003, "duplicate"));
+    REQUIRE(tree.isFlat());
+
+    // while flat, traversals follow the tree a promotion would build
+    AVLTree balanced = AVLTree::buildFromSorted(entries.begin(), entries.end());
+    for (AVLTree::Traversal type : {AVLTree::INORDER, AVLTree::PREORDER, AVLTree::POSTORDER, AVLTree::LEVELORDER})
+        REQUIRE(tree.traversalToString(type) == balanced.traversalToString(type));
+    REQUIRE(tree.search("NameA") == balanced.search("NameA"));
+    REQUIRE(tree.levelCount() == balanced.levelCount());
+    REQUIRE(tree.search(10000004) == "NameA");
+
+    REQUIRE(tree.insert(10000008, "NameA"));
+    REQUIRE(tree.insert(10000009, "NameB"));
+    REQUIRE(!tree.isFlat());
+    REQUIRE(tree.search(10000009) == "NameB");
+    REQUIRE(tree.remove(10000009));
+    REQUIRE(tree.removeInorder(0));
+    REQUIRE(tree.remove(10000005));
+    REQUIRE(tree.remove(10000006));
+    REQUIRE(tree.removeInorder(2));
+    REQUIRE(!tree.isFlat()); // hysteresis: still a tree at half the threshold
+    REQUIRE(tree.remove(10000008));
+    REQUIRE(tree.isFlat());
+    REQUIRE(tree.size() == 3);
+    REQUIRE(tree.traversalToString(AVLTree::INORDER) == "NameA, NameB, NameB");
+    REQUIRE(!tree.removeInorder(3));
+}
+
+TEST_CASE("Finger insertion and search")
+{
+    AVLTree hinted, reference;
+    std::mt19937 generator(38);
+    int previous = 0;
+    for (int i = 0; i < 5000; i++)
+    {
+        // mostly ascending IDs, with some jumps back and some duplicates
+        const int id = (i % 7 == 0) ? static_cast<int>(generator() % 20000) : previous + 1 + static_cast<int>(generator() % 3);
+        REQUIRE(hinted.insertHint(previous, id, to_string(id)) == reference.insert(id, to_string(id)));
+        previous = id;
+        if (i % 500 == 0) REQUIRE(hinted.remove(id) == reference.remove(id));
+    }
+    // rebalancing along the finger makes the same rotations as a descent from the root
+    REQUIRE(hinted.traversalToString(AVLTree::PREORDER) == reference.traversalToString(AVLTree::PREORDER));
+
+    for (int id = -1; id <= previous + 1; id++) REQUIRE(hinted.searchNear(id) == reference.search(id));
+    for (int id = previous + 1; id >= -1; id -= 3) REQUIRE(hinted.searchNear(id) == reference.search(id));
+
+    AVLTree empty;
+    REQUIRE(empty.searchNear(5).empty());
+    REQUIRE(empty.insertHint(0, 5, "5"));
+    REQUIRE(!empty.insertHint(5, 5, "duplicate"));
+    REQUIRE(empty.searchNear(5) == "5");
+}
+
+TEST_CASE("Pop min and max")
+{
+    AVLTree tree;
+    std::set<int> reference;
+    REQUIRE(tree.min() == -1);
+    REQUIRE(!tree.popMax());
+
+    std::mt19937 generator(39);
+    for (int i = 0; i < 20000; i++)
+    {
+        const int id = static_cast<int>(generator() % 100000);
+        const unsigned operation = generator() % 8;
+        if (operation < 4)
+        {
+            REQUIRE(tree.insert(id, to_string(id)) == reference.insert(id).second);
+        }
+        else if (operation < 6)
+        {
+            int popped = -1;
+            string name;
+            REQUIRE(tree.popMin(&popped, &name) == !reference.empty());
+            if (reference.empty()) continue;
+            REQUIRE(popped == *reference.begin());
+            REQUIRE(name == to_string(popped));
+            reference.erase(reference.begin());
+        }
+        else
+        {
+            int popped = -1;
+            REQUIRE(tree.popMax(&popped) == !reference.empty());
+            if (reference.empty()) continue;
+            REQUIRE(popped == *reference.rbegin());
+            reference.erase(std::prev(reference.end()));
+        }
+        REQUIRE(tree.min() == (reference.empty() ? -1 : *reference.begin()));
+        REQUIRE(tree.max() == (reference.empty() ? -1 : *reference.rbegin()));
+    }
+
+    // popping alone keeps the tree within the AVL height bound
+    for (size_t count = reference.size(); tree.popMin(); count--)
+        if (count % 97 == 0) REQUIRE(tree.levelCount() <= 1.45 * std::log2(count + 1.0) + 1);
+    REQUIRE(tree.traversalToString(AVLTree::INORDER).empty());
+}
+
+TEST_CASE("Remove range and batch")
+{
+    AVLTree tree;
+    std::set<int> reference;
+    for (int id = 0; id < 3000; id += 3) { tree.insert(id, to_string(id)); reference.insert(id); }
+    tree.enableHashIndex();
+
+    REQUIRE(tree.removeRange(100, 199) == 33);
+    REQUIRE(tree.removeRange(300, 300) == 1);
+    REQUIRE(tree.removeRange(301, 302) == 0);
+    REQUIRE(tree.removeRange(500, 400) == 0);
+    reference.erase(reference.lower_bound(100), reference.upper_bound(199));
+    reference.erase(300);
+    REQUIRE(tree.search(102).empty());
+    REQUIRE(tree.search(201) == "201");
+
+    vector<int> batch = {2997, 0, 9, 10, 600, 600, 99999};
+    REQUIRE(tree.removeBatch(batch) == 4);
+    for (int id : batch) reference.erase(id);
+    REQUIRE(tree.search(600).empty());
+    REQUIRE(!tree.insert(603, "duplicate"));
+
+    // inorder counts 5 through 9 of the remaining IDs
+    REQUIRE(tree.removeInorderRange(5, 9) == 5);
+    auto first = std::next(reference.begin(), 5);
+    reference.erase(first, std::next(first, 5));
+    REQUIRE(tree.removeInorderRange(static_cast<int>(reference.size()), 100000) == 0);
+    REQUIRE(tree.removeInorderRange(static_cast<int>(reference.size()) - 2, 100000) == 2);
+    reference.erase(std::prev(reference.end(), 2), reference.end());
+
+    string expected;
+    for (int id : reference) expected += to_string(id) + ", ";
+    expected.resize(expected.size() - 2);
+    REQUIRE(tree.traversalToString(AVLTree::INORDER) == expected);
+    REQUIRE(tree.levelCount() <= 1.45 * std::log2(reference.size() + 1.0) + 1);
+
+    REQUIRE(tree.removeRange(INT_MIN, INT_MAX) == reference.size());
+    REQUIRE(tree.traversalToString(AVLTree::INORDER).empty());
+}
+
+TEST_CASE("Concurrent tree")
+{
+    for (ConcurrentAVLTree::Mode mode : {ConcurrentAVLTree::SHARED_LOCK, ConcurrentAVLTree::SEQLOCK})
+    {
+        ConcurrentAVLTree tree(mode);
+        for (int id = 0; id < 1000; id += 2) tree.insert(id, to_string(id));
+
+        // writers churn disjoint ranges of odd IDs while readers check every name they find
+        atomic<bool> is_wrong(false);
+        vector<thread> threads;
+        for (int writer = 0; writer < 2; writer++)
+        {
+            threads.emplace_back([&tree, writer]()
+            {
+                for (int round = 0; round < 20; round++)
+                    for (int id = 1 + 500 * writer; id < 500 * (writer + 1); id += 2)
+                        round % 2 ? tree.remove(id) : tree.insert(id, to_string(id));
+            });
+        }
+        for (int reader = 0; reader < 2; reader++)
+        {
+            threads.emplace_back([&tree, &is_wrong]()
+            {
+                for (int round = 0; round < 20; round++)
+                {
+                    for (int id = 0; id < 1000; id++)
+                    {
+                        const string name = tree.search(id);
+                        if (!name.empty() && name != to_string(id)) is_wrong = true;
+                        if (id % 2 == 0 && name.empty()) is_wrong = true; // even IDs are never removed
+                    }
+                }
+            });
+        }
+        for (thread& worker : threads) worker.join();
+        REQUIRE(!is_wrong);
+
+        string expected;
+        for (int id = 0; id < 1000; id += 2) expected += to_string(id) + ", ";
+        expected.resize(expected.size() - 2);
+        REQUIRE(tree.traversalToString(AVLTree::INORDER) == expected); // an even number of rounds leaves odd IDs out
+    }
+}
+
+TEST_CASE("Persistent tree")
+{
+    PersistentAVLTree tree;
+    AVLTree reference;
+    std::mt19937 generator(42);
+    for (int i = 0; i < 5000; i++)
+    {
+        const int id = static_cast<int>(generator() % 2000);
+        const unsigned operation = generator() % 5;
+        if (operation < 3) REQUIRE(tree.insert(id, to_string(id)) == reference.insert(id, to_string(id))); else
+        if (operation < 4) REQUIRE(tree.remove(id) == reference.remove(id));
+        else REQUIRE(tree.removeInorder(id % 700) == reference.removeInorder(id % 700));
+    }
+    // path copying makes the same rotations as the mutable tree
+    REQUIRE(tree.traversalToString(PersistentAVLTree::PREORDER) == reference.traversalToString(AVLTree::PREORDER));
+    REQUIRE(tree.traversalToString(PersistentAVLTree::LEVELORDER) == reference.traversalToString(AVLTree::LEVELORDER));
+    REQUIRE(tree.levelCount() == reference.levelCount());
+    REQUIRE(tree.search("0") == reference.search("0"));
+
+    // a snapshot keeps its version while the tree moves on
+    PersistentAVLTree snapshot = tree.snapshot();
+    const string before = snapshot.traversalToString(PersistentAVLTree::INORDER);
+    const size_t size = snapshot.size();
+    for (int id = 0; id < 2000; id += 2) tree.remove(id);
+    REQUIRE(snapshot.traversalToString(PersistentAVLTree::INORDER) == before);
+    REQUIRE(snapshot.size() == size);
+    REQUIRE(tree.size() < size);
+
+    // a version pinned by a reader does not change while a writer publishes new ones
+    PersistentAVLTree shared;
+    atomic<bool> is_done(false), is_torn(false);
+    thread writer([&shared, &is_done]()
+    {
+        for (int round = 0; round < 200; round++)
+        {
+            for (int id = 0; id < 20; id += 2) { shared.insert(id, "a"); shared.insert(id + 1, "b"); }
+            for (int id = 0; id < 20; id += 2) { shared.remove(id); shared.remove(id + 1); }
+        }
+        is_done = true;
+    });
+    while (!is_done)
+    {
+        PersistentAVLTree version = shared.snapshot();
+        const string names = version.traversalToString(PersistentAVLTree::INORDER);
+        const size_t count = names.empty() ? 0 : std::count(names.begin(), names.end(), ',') + 1;
+        if (count != version.size() || names != version.traversalToString(PersistentAVLTree::INORDER)) is_torn = true;
+    }
+    writer.join();
+    REQUIRE(!is_torn);
+    REQUIRE(shared.size() == 0);
+}
+
+/**
+ *  @brief  Run writers that update a concurrent tree, each over IDs no other writer touches, and check every
+ *          result against a map of the writer's own, which is linearizable per ID; readers run alongside
+ *  @param  tree  tree, possibly holding IDs already, which are listed in the expected map
+ *  @param  writers  number of writer threads
+ *  @param  operations  number of operations per writer
+ *  @param  pick_id  function picking the next ID of a writer from its generator
+ *  @param  readers  functions run on threads of their own while the writers are, each told whether writers are
+ *          still running and returning whether what it read was right
+ *  @param  expected  map to which the IDs and names the writers leave are added
+ *  @return boolean indicating whether every result matched
+ */
+template <typename Tree>
+bool checkWriters(Tree& tree, const int writers, const int operations,
+                  const std::function<int(int writer, std::mt19937& generator)>& pick_id,
+                  const vector<std::function<bool(const atomic<bool>& is_writing)>>& readers,
+                  std::map<int, string>& expected)
+{
+    vector<std::map<int, string>> references(writers);
+    atomic<bool> is_wrong(false);
+    atomic<bool> is_writing(true);
+    atomic<int> writers_left(writers);
+    vector<thread> threads;
+    for (int writer = 0; writer < writers; writer++)
+    {
+        threads.emplace_back([&, writer]()
+        {
+            std::map<int, string>& reference = references[writer];
+            std::mt19937 generator(writer);
+            for (int i = 0; i < operations; i++)
+            {
+                const int id = pick_id(writer, generator);
+                const string name = to_string(id);
+                switch (generator() % 3)
+                {
+                    case 0: if (tree.insert(id, name) != reference.emplace(id, name).second) is_wrong = true; break;
+                    case 1: if (tree.remove(id) != (reference.erase(id) == 1)) is_wrong = true; break;
+                    default: if (tree.search(id) != (reference.count(id) ? name : "")) is_wrong = true;
+                }
+            }
+            if (!--writers_left) is_writing = false;
+        });
+    }
+    for (const std::function<bool(const atomic<bool>&)>& reader : readers)
+        threads.emplace_back([&is_wrong, &is_writing, &reader]() { if (!reader(is_writing)) is_wrong = true; });
+    for (thread& worker : threads) worker.join();
+
+    for (const std::map<int, string>& reference : references) expected.insert(reference.begin(), reference.end());
+    return !is_wrong;
+}
+
+TEST_CASE("Optimistic tree")
+{
+    OptimisticAVLTree tree;
+    std::map<int, string> expected;
+    for (int id = 0; id < 4000; id += 4)
+    {
+        tree.insert(id, to_string(id));
+        expected.emplace(id, to_string(id));
+    }
+
+    // each writer owns a range of 1000 IDs, skipping the multiples of 4, which readers check are never lost
+    const int writers = 4;
+    const auto pick_id = [](const int writer, std::mt19937& generator)
+    {
+        int id;
+        do id = 1000 * writer + static_cast<int>(generator() % 1000); while (id % 4 == 0);
+        return id;
+    };
+    const auto check_kept = [&tree](const atomic<bool>&)
+    {
+        for (int round = 0; round < 10; round++)
+            for (int id = 0; id < 4000; id += 4) if (tree.search(id) != to_string(id)) return false;
+        return true;
+    };
+    REQUIRE(checkWriters(tree, writers, 20000, pick_id, {check_kept, check_kept}, expected));
+
+    string expected_inorder;
+    for (const auto& entry : expected) expected_inorder += entry.second + ", ";
+    expected_inorder.resize(expected_inorder.size() - 2);
+    REQUIRE(tree.traversalToString() == expected_inorder);
+    REQUIRE(tree.size() == expected.size());
+
+    // once quiet, the repairs left by every update have been made
+    REQUIRE(tree.levelCount() <= 1.45 * std::log2(4000 + 2));
+
+    // every writer updates the same few IDs, so results depend on the interleaving: per ID, successful insertions
+    // and removals must alternate, leaving their difference at whether the ID remains, while traversals overlapping
+    // the updates must still list a sorted set of the IDs
+    OptimisticAVLTree contended;
+    const int ids = 32;
+    vector<vector<int>> balances(writers, vector<int>(ids, 0));
+    atomic<bool> is_wrong(false);
+    atomic<int> writers_left(writers);
+    vector<thread> threads;
+    for (int writer = 0; writer < writers; writer++)
+    {
+        threads.emplace_back([&contended, &balances, &is_wrong, &writers_left, writer]()
+        {
+            std::mt19937 generator(100 + writer);
+            for (int i = 0; i < 20000; i++)
+            {
+                const int id = static_cast<int>(generator() % ids);
+                switch (generator() % 3)
+                {
+                    case 0: if (contended.insert(id, to_string(id))) balances[writer][id]++; break;
+                    case 1: if (contended.remove(id)) balances[writer][id]--; break;
+                    default:
+                    {
+                        const string name = contended.search(id);
+                        if (!name.empty() && name != to_string(id)) is_wrong = true;
+                    }
+                }
+            }
+            writers_left--;
+        });
+    }
+    threads.emplace_back([&contended, &is_wrong, &writers_left]()
+    {
+        while (writers_left)
+        {
+            std::istringstream names(contended.traversalToString());
+            int previous = -1;
+            int id;
+            while (names >> id)
+            {
+                if (id <= previous || id >= ids) is_wrong = true;
+                previous = id;
+                names.ignore(2); // skips the separator
+            }
+        }
+    });
+    for (thread& worker : threads) worker.join();
+    REQUIRE(!is_wrong);
+
+    size_t remaining = 0;
+    for (int id = 0; id < ids; id++)
+    {
+        int balance = 0;
+        for (const vector<int>& balance_of_writer : balances) balance += balance_of_writer[id];
+        REQUIRE(balance == (contended.search(id).empty() ? 0 : 1));
+        remaining += balance;
+    }
+    REQUIRE(contended.size() == remaining);
+
+    // sequentially, every traversal order and removal by inorder count match the sequential tree's
+    OptimisticAVLTree optimistic;
+    AVLTree sequential;
+    for (int id = 0; id < 200; id++)
+    {
+        optimistic.insert(id, to_string(id));
+        sequential.insert(id, to_string(id));
+    }
+    for (const int count : {0, 57, 100, 0, 150, 195, 300})
+        REQUIRE(optimistic.removeInorder(count) == sequential.removeInorder(count));
+    REQUIRE(!optimistic.removeInorder(-1));
+    for (const AVLTree::Traversal type : {AVLTree::INORDER, AVLTree::PREORDER, AVLTree::POSTORDER, AVLTree::LEVELORDER})
+        REQUIRE(optimistic.traversalToString(type) == sequential.traversalToString(type));
+
+    // the IDs of routing OptimisticNodes are skipped by the inorder count
+    optimistic.remove(63);
+    sequential.remove(63);
+    optimistic.removeInorder(62);
+    sequential.removeInorder(62);
+    REQUIRE(optimistic.traversalToString() == sequential.traversalToString(AVLTree::INORDER));
+}
+
+TEST_CASE("Epoch reclamation")
+{
+    EpochManager epochs;
+    size_t released = 0;
+    void (*release)(void*, void*) = [](void* pointer, void* context)
+    {
+        delete static_cast<int*>(pointer);
+        (*static_cast<size_t*>(context))++;
+    };
+
+    {
+        EpochManager::Guard guard(epochs); // a reader that may hold the object
+        epochs.retire(new int(1), release, &released, 1);
+        for (int i = 0; i < 5; i++) epochs.collect();
+        REQUIRE(released == 0);
+        REQUIRE(epochs.pendingCount() == 1);
+        REQUIRE(epochs.reclamationLag() == 1); // the pinned reader holds the epoch back after one advance
+    }
+    epochs.collect();
+    REQUIRE(released == 1);
+    REQUIRE(epochs.pendingCount() == 0);
+    REQUIRE(epochs.reclamationLag() == 0);
+    REQUIRE(epochs.releasedCount() == 1);
+
+    // without readers, retiring reclaims in batches and keeps the garbage bounded
+    for (int i = 0; i < 1000; i++) epochs.retire(new int(i), release, &released, 1);
+    REQUIRE(epochs.pendingCount() <= 2 * EpochManager::COLLECT_THRESHOLD);
+    REQUIRE(released + epochs.pendingCount() == 1001);
+
+    // writers that unlink Nodes under readers never leave them more than a few batches behind once quiet
+    ConcurrentAVLTree tree(ConcurrentAVLTree::SEQLOCK);
+    atomic<bool> is_done(false);
+    thread reader([&tree, &is_done]() { while (!is_done) tree.search(7); });
+    for (int round = 0; round < 200; round++)
+    {
+        for (int id = 0; id < 50; id++) tree.insert(id, "x");
+        for (int id = 0; id < 50; id++) tree.remove(id);
+    }
+    is_done = true;
+    reader.join();
+    for (int id = 0; id < 200; id++) { tree.insert(id, "x"); tree.remove(id); }
+    REQUIRE(tree.retiredCount() <= 2 * EpochManager::COLLECT_THRESHOLD);
+}
+
+TEST_CASE("Flat combining tree")
+{
+    FlatCombiningAVLTree tree;
+    std::map<int, string> expected;
+    for (int id = -1; id > -20000; id--)
+    {
+        tree.insert(id, to_string(id));
+        expected.emplace(id, to_string(id));
+    }
+
+    // IDs interleave across writers; a reader now and then holds the combiner through a long traversal, so that
+    // writers publish meanwhile and the next combiner applies their operations together
+    const int writers = 4;
+    const auto pick_id = [](const int writer, std::mt19937& generator)
+    {
+        return writer + writers * static_cast<int>(generator() % 500);
+    };
+    const auto traverse = [&tree](const atomic<bool>& is_writing)
+    {
+        for (int round = 0; round < 20 && is_writing; round++)
+        {
+            if (tree.traversalToString(AVLTree::INORDER).empty()) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    };
+    REQUIRE(checkWriters(tree, writers, 5000, pick_id, {traverse}, expected));
+    REQUIRE(tree.averageBatch() > 1);
+
+    AVLTree reference_tree;
+    for (const auto& entry : expected) reference_tree.insert(entry.first, entry.second);
+    REQUIRE(tree.traversalToString(AVLTree::INORDER) == reference_tree.traversalToString(AVLTree::INORDER));
+    REQUIRE(tree.levelCount() <= 1.45 * std::log2(expected.size() + 2));
+}
+
+TEST_CASE("Sharded tree")
+{
+    ThreadPool pool(4);
+    ShardedAVLTree tree(8);
+
+    // ingestion crowded into the first shard's range is split and joined until the shards are even
+    vector<pair<int, string>> entries;
+    for (int id = 0; id < 20000; id++) entries.emplace_back(id * 7 % 20000, to_string(id * 7 % 20000));
+    entries.emplace_back(5, "duplicate");
+    REQUIRE(tree.insertBatch(std::move(entries), pool) == 20000);
+    REQUIRE(tree.size() == 20000);
+    REQUIRE(tree.rebalanceCount() > 0);
+    const vector<size_t> sizes = tree.shardSizes();
+    REQUIRE(sizes.size() == 8);
+    for (size_t size : sizes) REQUIRE(size <= ShardedAVLTree::SKEW_FACTOR * 20000 / 8 + ShardedAVLTree::MIN_SPLIT_SIZE);
+
+    string expected;
+    for (int id = 0; id < 20000; id++) expected += to_string(id) + ", ";
+    expected.resize(expected.size() - 2);
+    REQUIRE(tree.traversalToString() == expected);
+
+    vector<int> ids;
+    for (int id = 19999; id >= 0; id -= 3) ids.push_back(id);
+    ids.push_back(ShardedAVLTree::ID_LIMIT - 1);
+    const vector<string> matches = tree.searchBatch(ids, pool);
+    for (size_t i = 0; i + 1 < ids.size(); i++) REQUIRE(matches[i] == to_string(ids[i]));
+    REQUIRE(matches.back().empty());
+    REQUIRE(tree.removeBatch(ids, pool) == ids.size() - 1);
+    REQUIRE(tree.search(19999).empty());
+    REQUIRE(tree.search(19998) == "19998");
+
+    // single operations from several threads, each over its own IDs, alongside rebalancing
+    vector<thread> threads;
+    for (int writer = 0; writer < 4; writer++)
+    {
+        threads.emplace_back([&tree, writer]()
+        {
+            for (int id = 20000 + writer; id < 40000; id += 4) tree.insert(id, to_string(id));
+            for (int id = 20000 + writer; id < 40000; id += 8) tree.remove(id);
+        });
+    }
+    for (thread& worker : threads) worker.join();
+    REQUIRE(tree.size() == 20000 - (ids.size() - 1) + 10000);
+    REQUIRE(tree.search(20001).empty());
+    REQUIRE(tree.search(20005) == "20005");
+}
+
+TEST_CASE("Partitioned runtime")
+{
+    // commands whose answers do not depend on the shape of the tree, spread over every partition's range
+    std::mt19937 generator(47);
+    std::uniform_int_distribution<int> keys(0, 39);
+    std::ostringstream script;
+    int command_count = 0;
+    for (int i = 0; i < 3000; i++)
+    {
+        string id_str = to_string(keys(generator) * 2500000);
+        id_str.insert(0, 8 - id_str.size(), '0');
+        switch (i % 7)
+        {
+            case 0: case 1: case 2: script << "insert \"Name " << char('a' + i % 26) << "\" " << id_str << '\n'; break;
+            case 3: script << "remove " << id_str << '\n'; break;
+            case 4: script << "search " << id_str << '\n'; break;
+            case 5: script << (i % 5 ? "removeInorder " + to_string(i % 23) : string("printInorder")) << '\n'; break;
+            case 6: script << (i % 3 ? "search \"Nobody\"" : "remove 123") << '\n'; break;
+        }
+        command_count++;
+    }
+
+    std::istringstream expected_input(script.str());
+    std::ostringstream expected;
+    std::streambuf* const cin_buffer = cin.rdbuf(expected_input.rdbuf());
+    std::streambuf* const cout_buffer = cout.rdbuf(expected.rdbuf());
+    AVLTree tree;
+    for (int i = 0; i < command_count; i++) tree = handleCommand(std::move(tree));
+    cin.rdbuf(cin_buffer);
+    cout.rdbuf(cout_buffer);
+
+    for (unsigned partitions : {1u, 3u, 8u})
+    {
+        std::istringstream input(script.str());
+        std::ostringstream output;
+        {
+            PartitionedRuntime runtime(partitions, 4); // small queues, so the dispatcher often waits for answers
+            REQUIRE(runtime.partitionCount() == partitions);
+            runtime.run(input, output, command_count);
+        }
+        REQUIRE(output.str() == expected.str());
+    }
+}